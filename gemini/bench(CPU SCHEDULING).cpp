@@ -0,0 +1,256 @@
+/*
+Benchmark for the CPU scheduling simulators: gemini/third(CPU SCHEDULING).cpp,
+CPU SCHEDULING.txt and ROUND ROBIN.txt, over workloads of 1e2 .. 1e7 processes.
+
+Build:  g++ -std=c++17 -O2 -pthread "bench(CPU SCHEDULING).cpp" -o bench_cpu
+Run:    ./bench_cpu [--max=N] [--budget=SECONDS] [--json=FILE] [--compare=OLD.json]
+
+Each (algorithm, size) case runs in its own child process, so peak RSS is per
+case and a case that blows the time budget is killed without stopping the run.
+Once an algorithm times out, its larger sizes are skipped.
+*/
+#include <bits/stdc++.h>
+#include <pthread.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+using namespace std;
+
+// The simulators are included as-is; each gets its own namespace because they
+// all define Process / fcfs / main.
+#define main unused_main
+namespace gemini {
+#include "third(CPU SCHEDULING).cpp"
+}
+namespace classic {
+#include "../CPU SCHEDULING.txt"
+}
+namespace rrtxt {
+#include "../ROUND ROBIN.txt"
+}
+#undef main
+
+// --- 1. Workloads ---
+// Arrivals spread so the single CPU is roughly fully utilized.
+vector<gemini::Process> workload(int n) {
+    return gemini::randomWorkload(n, max(1, n * 10), 20, 12345);
+}
+
+// "Events" = scheduling decisions, derived from the workload so they are the
+// same for every implementation of a policy:
+//   FCFS / Priority: one dispatch per process
+//   SRTF (unit-step): one decision per simulated time unit (= makespan)
+//   Round Robin:      one dispatch per slice, sum of ceil(BT / quantum)
+long long makespan(const vector<gemini::Process> &p) {
+    vector<gemini::Process> s = p;
+    sort(s.begin(), s.end(), [](auto &a, auto &b) { return a.at < b.at; });
+    long long t = 0;
+    for (auto &x : s) t = max(t, (long long)x.at) + x.bt;
+    return t;
+}
+long long rrSlices(const vector<gemini::Process> &p, int q) {
+    long long s = 0;
+    for (auto &x : p) s += (x.bt + q - 1) / q;
+    return s;
+}
+
+struct Case {
+    string name;
+    function<long long(const vector<gemini::Process> &)> events;
+    function<void(const vector<gemini::Process> &)> run;
+};
+
+vector<Case> cases() {
+    auto toClassic = [](const vector<gemini::Process> &p) {
+        vector<classic::Process> c;
+        c.reserve(p.size());
+        for (auto &x : p) c.push_back({x.pid, x.at, x.bt, x.prio, 0});
+        return c;
+    };
+    auto perProcess = [](const vector<gemini::Process> &p) { return (long long)p.size(); };
+    return {
+        {"gemini/fcfs", perProcess, [](auto &p) { gemini::fcfs(p); }},
+        {"gemini/sjf", makespan, [](auto &p) { gemini::sjf(p); }},
+        {"gemini/prioritySched", perProcess, [](auto &p) { gemini::prioritySched(p); }},
+        {"gemini/roundRobin", [](auto &p) { return rrSlices(p, 2); },
+         [](auto &p) { gemini::roundRobin(p, 2); }},
+        {"txt/fcfs", perProcess, [=](auto &p) { classic::fcfs(toClassic(p)); }},
+        {"txt/sjf_preemptive", makespan, [=](auto &p) { classic::sjf_preemptive(toClassic(p)); }},
+        {"txt/priority_non_preemptive", perProcess,
+         [=](auto &p) { classic::priority_non_preemptive(toClassic(p)); }},
+        {"txt/round_robin", [](auto &p) { return rrSlices(p, 3); },
+         [=](auto &p) { classic::round_robin(toClassic(p), 3); }},
+        {"txt/ROUND_ROBIN", [](auto &p) { return rrSlices(p, 2); },
+         [](auto &p) {
+             // ROUND ROBIN.txt ignores arrival times and takes plain arrays
+             int n = p.size();
+             vector<int> ids(n), bt(n);
+             for (int i = 0; i < n; i++) ids[i] = p[i].pid, bt[i] = p[i].bt;
+             rrtxt::findavgTime(ids.data(), n, bt.data(), 2);
+         }},
+    };
+}
+
+// --- 2. Running one case in a child process ---
+struct Result {
+    string name;
+    int n;
+    string status = "ok";
+    double seconds = 0;
+    long long events = 0, peakRssKb = 0;
+};
+
+// ROUND ROBIN.txt keeps its arrays on the stack, so cases run on a big stack.
+void runOnBigStack(function<void()> f) {
+    pthread_attr_t attr;
+    pthread_attr_init(&attr);
+    pthread_attr_setstacksize(&attr, size_t(1) << 30);
+    pthread_t th;
+    pthread_create(&th, &attr, [](void *arg) -> void * {
+        (*static_cast<function<void()> *>(arg))();
+        return nullptr;
+    }, &f);
+    pthread_join(th, nullptr);
+    pthread_attr_destroy(&attr);
+}
+
+Result runCase(const Case &c, int n, int budget) {
+    Result r{c.name, n};
+    int fd[2];
+    if (pipe(fd) != 0) {
+        r.status = "pipe failed";
+        return r;
+    }
+    pid_t child = fork();
+    if (child == 0) {
+        close(fd[0]);
+        alarm(budget);
+        vector<gemini::Process> p = workload(n);
+        // The simulators print their tables; send them to /dev/null so the
+        // formatting cost stays in the measurement but not on the terminal.
+        ofstream devnull("/dev/null");
+        cout.rdbuf(devnull.rdbuf());
+        double seconds = 0;
+        int reps = 0;
+        runOnBigStack([&] {
+            auto start = chrono::steady_clock::now();
+            do {
+                c.run(p);
+                reps++;
+                seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            } while (seconds < 0.2 && reps < 1000);
+        });
+        double perRun = seconds / reps;
+        ssize_t w = write(fd[1], &perRun, sizeof perRun);
+        _exit(w == sizeof perRun ? 0 : 1);
+    }
+    close(fd[1]);
+    double perRun = 0;
+    bool got = read(fd[0], &perRun, sizeof perRun) == sizeof perRun;
+    close(fd[0]);
+    int status = 0;
+    rusage ru{};
+    wait4(child, &status, 0, &ru);
+    r.peakRssKb = ru.ru_maxrss;
+    if (WIFSIGNALED(status))
+        r.status = WTERMSIG(status) == SIGALRM ? "timeout" : "signal " + to_string(WTERMSIG(status));
+    else if (!got)
+        r.status = "failed";
+    else
+        r.seconds = perRun;
+    return r;
+}
+
+// --- 3. JSON output and comparison ---
+// One result per line so --compare can read old files without a JSON library.
+void writeJson(const string &path, const vector<Result> &rs) {
+    ofstream out(path);
+    out << "{\n  \"benchmark\": \"cpu-scheduling\",\n  \"compiler\": \"" << __VERSION__
+        << "\",\n  \"results\": [\n";
+    for (size_t i = 0; i < rs.size(); i++) {
+        auto &r = rs[i];
+        out << "    {\"algorithm\": \"" << r.name << "\", \"n\": " << r.n
+            << ", \"status\": \"" << r.status << "\"";
+        if (r.status == "ok")
+            out << fixed << setprecision(9) << ", \"seconds\": " << r.seconds
+                << setprecision(3) << ", \"ns_per_process\": " << r.seconds * 1e9 / r.n
+                << ", \"events\": " << r.events
+                << ", \"events_per_sec\": " << r.events / max(r.seconds, 1e-12);
+        out << ", \"peak_rss_kb\": " << r.peakRssKb << "}" << (i + 1 < rs.size() ? "," : "") << "\n";
+    }
+    out << "  ]\n}\n";
+}
+
+map<pair<string, int>, double> readJson(const string &path) {
+    map<pair<string, int>, double> old;
+    ifstream in(path);
+    regex line(R"re("algorithm": "([^"]+)", "n": (\d+), "status": "ok".*"ns_per_process": ([0-9.]+))re");
+    smatch m;
+    for (string s; getline(in, s);)
+        if (regex_search(s, m, line)) old[{m[1], stoi(m[2])}] = stod(m[3]);
+    return old;
+}
+
+int main(int argc, char *argv[]) {
+    long long maxN = 10000000;
+    int budget = 10;
+    string jsonPath = "bench_cpu_scheduling.json", comparePath;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a.rfind("--max=", 0) == 0) maxN = (long long)stod(a.substr(6));
+        else if (a.rfind("--budget=", 0) == 0) budget = stoi(a.substr(9));
+        else if (a.rfind("--json=", 0) == 0) jsonPath = a.substr(7);
+        else if (a.rfind("--compare=", 0) == 0) comparePath = a.substr(10);
+        else {
+            cerr << "usage: " << argv[0] << " [--max=N] [--budget=SECONDS] [--json=FILE] [--compare=OLD.json]\n";
+            return 1;
+        }
+    }
+
+    vector<Result> results;
+    cout << left << setw(30) << "Algorithm" << right << setw(10) << "N" << setw(14) << "ns/process"
+         << setw(16) << "events/sec" << setw(14) << "peak RSS KB" << "\n";
+    cout << string(84, '-') << "\n";
+    for (auto &c : cases()) {
+        bool skip = false;
+        for (long long n = 100; n <= maxN; n *= 10) {
+            Result r{c.name, (int)n};
+            if (skip) {
+                r.status = "skipped";
+            } else {
+                r = runCase(c, n, budget);
+                if (r.status == "ok") r.events = c.events(workload(n));
+                else skip = true;
+            }
+            cout << left << setw(30) << r.name << right << setw(10) << r.n;
+            if (r.status == "ok")
+                cout << fixed << setprecision(1) << setw(14) << r.seconds * 1e9 / n
+                     << setw(16) << setprecision(0) << r.events / max(r.seconds, 1e-12);
+            else
+                cout << setw(30) << r.status;
+            cout << setw(14) << r.peakRssKb << "\n";
+            results.push_back(r);
+        }
+    }
+    writeJson(jsonPath, results);
+    cout << "\nResults written to " << jsonPath << "\n";
+
+    // Flag cases more than 10% slower per process than the old run
+    if (!comparePath.empty()) {
+        auto old = readJson(comparePath);
+        int regressions = 0;
+        for (auto &r : results) {
+            auto it = old.find({r.name, r.n});
+            if (r.status != "ok" || it == old.end()) continue;
+            double now = r.seconds * 1e9 / r.n;
+            if (now > it->second * 1.10) {
+                regressions++;
+                cout << "REGRESSION " << r.name << " n=" << r.n << ": " << it->second
+                     << " -> " << now << " ns/process\n";
+            }
+        }
+        cout << regressions << " regression(s) against " << comparePath << "\n";
+        return regressions ? 2 : 0;
+    }
+    return 0;
+}
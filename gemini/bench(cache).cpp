@@ -0,0 +1,134 @@
+/*
+Multi-threaded throughput benchmark for cachelib::ConcurrentClockCache in
+gemini/cache.h (sharded CLOCK, lock-free reads) against one cachelib CLOCK
+cache behind a single mutex. Every thread reads its own Zipfian key stream and
+puts each missed key, as a look-aside cache in a service would.
+
+Build:  g++ -std=c++17 -O2 -pthread "bench(cache).cpp" -o bench_cache
+Run:    ./bench_cache [--threads=N] [--ops=N] [--keys=N] [--capacity=N] [--shards=N] [--zipf=S]
+
+Thread counts double from 1 up to --threads (default: the number of CPUs).
+Scaling only shows with that many idle cores; past the core count the
+threads just take turns.
+*/
+#include <bits/stdc++.h>
+using namespace std;
+
+#define main unused_main
+#include "fourth(page replacement).cpp"
+#undef main
+
+using Key = uint64_t;
+using Value = uint64_t;
+
+// --- 1. The caches under test ---
+struct MutexClock {
+    mutex lock;
+    cachelib::Cache<Key, Value, cachelib::Clock> cache;
+    explicit MutexClock(int capacity) : cache(capacity) {}
+    bool get(Key k, Value &v) {
+        lock_guard<mutex> g(lock);
+        const Value *p = cache.get(k);
+        if (!p) return false;
+        v = *p;
+        return true;
+    }
+    void put(Key k, Value v) {
+        lock_guard<mutex> g(lock);
+        cache.put(k, v);
+    }
+};
+
+struct Sharded {
+    cachelib::ConcurrentClockCache<Key, Value> cache;
+    Sharded(int capacity, int shards) : cache(capacity, shards) {}
+    bool get(Key k, Value &v) { return cache.get(k, v); }
+    void put(Key k, Value v) { cache.put(k, v); }
+};
+
+// --- 2. One run: T threads, each over its own stream ---
+struct Run {
+    double mops, hitRatio;
+};
+
+template <class Cache>
+Run run(Cache &cache, const vector<vector<Key>> &streams, int threads) {
+    atomic<int> ready{0};
+    atomic<bool> go{false};
+    vector<long long> hits(threads);
+    vector<thread> pool;
+    for (int t = 0; t < threads; t++)
+        pool.emplace_back([&, t] {
+            const vector<Key> &keys = streams[t];
+            ready++;
+            while (!go.load(memory_order_acquire)) this_thread::yield();
+            long long h = 0;
+            Value v;
+            for (Key k : keys) {
+                if (cache.get(k, v)) h += v == k;
+                else cache.put(k, k);
+            }
+            hits[t] = h;
+        });
+    while (ready.load() < threads) this_thread::yield();
+    auto start = chrono::steady_clock::now();
+    go.store(true, memory_order_release);
+    for (auto &th : pool) th.join();
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    long long ops = 0, h = 0;
+    for (int t = 0; t < threads; t++) ops += streams[t].size(), h += hits[t];
+    return {ops / seconds / 1e6, (double)h / ops};
+}
+
+int main(int argc, char *argv[]) {
+    int maxThreads = max(1u, thread::hardware_concurrency());
+    int ops = 2000000, keys = 1000000, capacity = 100000, shards = 64;
+    double zipf = 0.99;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a.rfind("--threads=", 0) == 0) maxThreads = stoi(a.substr(10));
+        else if (a.rfind("--ops=", 0) == 0) ops = (int)stod(a.substr(6));
+        else if (a.rfind("--keys=", 0) == 0) keys = (int)stod(a.substr(7));
+        else if (a.rfind("--capacity=", 0) == 0) capacity = (int)stod(a.substr(11));
+        else if (a.rfind("--shards=", 0) == 0) shards = stoi(a.substr(9));
+        else if (a.rfind("--zipf=", 0) == 0) zipf = stod(a.substr(7));
+        else {
+            cerr << "usage: " << argv[0]
+                 << " [--threads=N] [--ops=N] [--keys=N] [--capacity=N] [--shards=N] [--zipf=S]\n";
+            return 1;
+        }
+    }
+    if (maxThreads < 1 || ops < 1 || keys < 1 || capacity < 1 || shards < 1) {
+        cerr << "counts must be positive\n";
+        return 1;
+    }
+
+    // Streams share the key space and popularity order but not the sequence
+    vector<vector<Key>> streams(maxThreads);
+    for (int t = 0; t < maxThreads; t++) {
+        vector<int> z = zipfTrace(ops, keys, zipf, 1000 + t);
+        streams[t].assign(z.begin(), z.end());
+    }
+
+    cachelib::ConcurrentClockCache<Key, Value> probe(capacity, shards);
+    cout << "Ops per thread: " << ops << ", keys: " << keys << ", zipf s=" << zipf
+         << ", capacity: " << capacity << ", shards: " << probe.shards()
+         << ", CPUs: " << thread::hardware_concurrency() << "\n\n";
+    cout << left << setw(8) << "Threads" << right << setw(14) << "mutex Mops/s" << setw(16)
+         << "sharded Mops/s" << setw(10) << "vs mutex" << setw(10) << "scaling" << setw(12)
+         << "efficiency" << setw(10) << "hit %" << "\n";
+    cout << string(80, '-') << "\n";
+    double base = 0;
+    for (int t = 1;; t = min(2 * t, maxThreads)) {
+        MutexClock locked(capacity);
+        Sharded sharded(capacity, shards);
+        Run m = run(locked, streams, t), s = run(sharded, streams, t);
+        if (t == 1) base = s.mops;
+        cout << left << setw(8) << t << right << fixed << setprecision(2) << setw(14) << m.mops
+             << setw(16) << s.mops << setw(9) << s.mops / m.mops << "x" << setw(9)
+             << s.mops / base << "x" << setw(11) << setprecision(0) << 100 * s.mops / base / t
+             << "%" << setw(10) << setprecision(1) << 100 * s.hitRatio << "\n";
+        if (t == maxThreads) break;
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+Benchmark for the small-frame residency check in gemini/fourth(page replacement).cpp:
+the scalar scan against the SSE4.1 and AVX2 versions of findFrame, on its own
+and inside the FIFO / CLOCK / second-chance engines, where it competes with
+the hash index. The crossover sets scanFrameLimit there.
+
+Build:  g++ -std=c++17 -O2 -pthread "bench(page replacement).cpp" -o bench_pages
+Run:    ./bench_pages [--refs=N]
+*/
+#include <bits/stdc++.h>
+using namespace std;
+
+#define main unused_main
+#include "fourth(page replacement).cpp"
+#undef main
+
+// --- 1. Traces ---
+// Zipf over twice as many pages as frames, so both hits and faults are common
+vector<Page> trace(int refs, int frames) {
+    vector<int> z = zipfTrace(refs, 2 * frames, 0.9, 777 + frames);
+    return vector<Page>(z.begin(), z.end());
+}
+
+double nsPerRef(const vector<Page> &t, const function<long long()> &run) {
+    run();                                              // warm up
+    long long sink = 0;
+    int reps = 0;
+    auto start = chrono::steady_clock::now();
+    double seconds;
+    do {
+        sink += run();
+        reps++;
+        seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    } while (seconds < 0.3);
+    if (sink == -1) cout << "";                         // keep the runs observable
+    return seconds * 1e9 / ((double)reps * t.size());
+}
+
+// --- 2. The residency check alone ---
+// Frames hold the first `frames` distinct pages of the trace; every reference
+// is looked up once.
+void kernels(const vector<int> &sizes, int refs) {
+    vector<pair<string, FindFrameFn>> fns = {{"scalar", findFrameScalar}};
+#if defined(__x86_64__) || defined(__i386__)
+    if (__builtin_cpu_supports("sse4.1")) fns.push_back({"sse4.1", findFrameSse4});
+    if (__builtin_cpu_supports("avx2")) fns.push_back({"avx2", findFrameAvx2});
+#endif
+    cout << "\n--- findFrame alone (ns/reference) ---\n" << left << setw(8) << "Frames";
+    for (auto &f : fns) cout << right << setw(10) << f.first;
+    cout << setw(12) << "speedup" << "\n";
+    for (int c : sizes) {
+        vector<Page> t = trace(refs, c), frames;
+        for (Page p : t)
+            if ((int)frames.size() < c && find(frames.begin(), frames.end(), p) == frames.end()) frames.push_back(p);
+        cout << left << setw(8) << c << right << fixed << setprecision(2);
+        double scalar = 0, best = 0;
+        for (auto &f : fns) {
+            double ns = nsPerRef(t, [&] {
+                long long hits = 0;
+                for (Page p : t) hits += f.second(frames.data(), frames.size(), p) >= 0;
+                return hits;
+            });
+            if (!scalar) scalar = ns;
+            best = ns;
+            cout << setw(10) << ns;
+        }
+        cout << setw(11) << scalar / best << "x\n";
+    }
+}
+
+// --- 3. Inside the engines ---
+template <class Frames>
+void engine(const string &name, const vector<int> &sizes, int refs) {
+    cout << "\n--- " << name << " (ns/reference) ---\n"
+         << left << setw(8) << "Frames" << right << setw(10) << "hash" << setw(10) << "scalar"
+         << setw(10) << "simd" << setw(12) << "vs hash" << setw(12) << "vs scalar" << "\n";
+    FindFrameFn best = findFrame;
+    int limit = scanFrameLimit;
+    for (int c : sizes) {
+        vector<Page> t = trace(refs, c);
+        auto run = [&](int limit, FindFrameFn fn) {
+            scanFrameLimit = limit;
+            findFrame = fn;
+            return nsPerRef(t, [&] {
+                Frames frames(c);
+                return countFaults(frames, t);
+            });
+        };
+        double hash = run(0, best), scalar = run(c, findFrameScalar), simd = run(c, best);
+        cout << left << setw(8) << c << right << fixed << setprecision(2) << setw(10) << hash
+             << setw(10) << scalar << setw(10) << simd << setw(11) << hash / simd << "x"
+             << setw(11) << scalar / simd << "x\n";
+    }
+    scanFrameLimit = limit;
+    findFrame = best;
+}
+
+int main(int argc, char *argv[]) {
+    int refs = 10000000;
+    for (int i = 1; i < argc; i++) {
+        string a = argv[i];
+        if (a.rfind("--refs=", 0) == 0) refs = (int)stod(a.substr(7));
+        else {
+            cerr << "usage: " << argv[0] << " [--refs=N]\n";
+            return 1;
+        }
+    }
+    vector<int> sizes = {4, 8, 16, 32, 64};
+    cout << "References per run: " << refs << "\n";
+    kernels(sizes, refs);
+    engine<FifoFrames>("FIFO", sizes, refs);
+    engine<ClockFrames>("CLOCK", sizes, refs);
+    engine<SecondChanceFrames>("Second Chance", sizes, refs);
+    return 0;
+}
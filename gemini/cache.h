@@ -0,0 +1,633 @@
+/*
+Header-only fixed-capacity cache with compile-time replacement policies: the
+library form of the LRU, FIFO, CLOCK and ARC simulators in
+fourth(page replacement).cpp, which now runs on this code. For use from many
+threads, ConcurrentClockCache at the end is a sharded CLOCK cache with
+lock-free reads.
+
+    cachelib::Cache<std::string, Blob, cachelib::Arc> cache(4096);
+    if (Blob *b = cache.get(key)) use(*b);
+    else cache.put(key, load(key));
+
+All storage is allocated by the constructor: entries live in `capacity`
+slots found through an open-addressing index, and the policies keep their
+lists and bits in per-slot arrays. get / put / erase never allocate (as
+long as copying Key and Value does not). Not thread-safe.
+
+A policy is a type with a nested State<Key, Hash> template:
+    State(int capacity, const Hash &hasher)
+    void touch(int slot)                   hit on the entry in slot
+    int miss(const Key &key, bool full, const Key *keys)
+                                           before an absent key is inserted:
+                                           when full, unlinks and returns the
+                                           slot to evict, otherwise -1. keys
+                                           is the slot array.
+    void insert(int slot, const Key &key)  key now occupies slot
+    void erase(int slot)                   entry removed by Cache::erase
+*/
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace cachelib {
+
+// key -> slot over keys stored elsewhere (the slot array, passed to find).
+// Buckets hold the slot and the key's 32-bit hash, so probes compare hashes
+// before keys and deletion re-homes entries without hashing again. Linear
+// probing with backward-shift deletion, at most half full, never resized.
+template <class Key, class Hash = std::hash<Key>>
+class FlatIndex {
+    struct Bucket { uint32_t hash; int32_t slot; };   // slot -1: empty
+    std::vector<Bucket> buckets;
+    size_t mask;
+    Hash hasher;
+
+public:
+    FlatIndex(size_t capacity, const Hash &hasher = Hash()) : hasher(hasher) {
+        size_t n = 8;
+        while (n < 2 * capacity) n <<= 1;
+        buckets.assign(n, {0, -1});
+        mask = n - 1;
+    }
+    // std::hash is the identity on integers: Fibonacci hashing spreads strided keys
+    uint32_t hash(const Key &key) const { return (uint64_t)hasher(key) * 0x9E3779B97F4A7C15ULL >> 32; }
+
+    int find(const Key &key, uint32_t h, const Key *keys) const {
+        for (size_t i = h & mask;; i = (i + 1) & mask) {
+            const Bucket &b = buckets[i];
+            if (b.slot < 0) return -1;
+            if (b.hash == h && keys[b.slot] == key) return b.slot;
+        }
+    }
+    // The key must be absent
+    void insert(uint32_t h, int slot) {
+        size_t i = h & mask;
+        while (buckets[i].slot >= 0) i = (i + 1) & mask;
+        buckets[i] = {h, slot};
+    }
+    void erase(uint32_t h, int slot) {
+        size_t i = h & mask;
+        while (buckets[i].slot != slot) {
+            if (buckets[i].slot < 0) return;
+            i = (i + 1) & mask;
+        }
+        // Shift later members of the probe run back so lookups never stop early
+        for (size_t j = (i + 1) & mask; buckets[j].slot >= 0; j = (j + 1) & mask) {
+            size_t home = buckets[j].hash & mask;
+            if (((j - home) & mask) >= ((j - i) & mask)) {
+                buckets[i] = buckets[j];
+                i = j;
+            }
+        }
+        buckets[i].slot = -1;
+    }
+};
+
+// Intrusive doubly-linked lists threaded through per-slot links; several
+// lists can share one Links (ARC's T1 and T2)
+struct Links {
+    std::vector<int32_t> prev, next;
+    explicit Links(int n) : prev(n), next(n) {}
+};
+
+struct List {
+    int head = -1, tail = -1, size = 0;
+
+    void pushFront(Links &l, int n) {
+        l.prev[n] = -1;
+        l.next[n] = head;
+        (head >= 0 ? l.prev[head] : tail) = n;
+        head = n;
+        size++;
+    }
+    void unlink(Links &l, int n) {
+        (l.prev[n] >= 0 ? l.next[l.prev[n]] : head) = l.next[n];
+        (l.next[n] >= 0 ? l.prev[l.next[n]] : tail) = l.prev[n];
+        size--;
+    }
+};
+
+// Least recently used: a recency list, head = most recent
+struct Lru {
+    template <class Key, class Hash>
+    struct State {
+        Links links;
+        List order;
+
+        State(int capacity, const Hash &) : links(capacity) {}
+        void touch(int slot) {
+            if (slot != order.head) order.unlink(links, slot), order.pushFront(links, slot);
+        }
+        int miss(const Key &, bool full, const Key *) {
+            if (!full) return -1;
+            int victim = order.tail;
+            order.unlink(links, victim);
+            return victim;
+        }
+        void insert(int slot, const Key &) { order.pushFront(links, slot); }
+        void erase(int slot) { order.unlink(links, slot); }
+    };
+};
+
+// First in, first out: insertion order, hits change nothing
+struct Fifo {
+    template <class Key, class Hash>
+    struct State : Lru::State<Key, Hash> {
+        using Lru::State<Key, Hash>::State;
+        void touch(int) {}
+    };
+};
+
+// CLOCK: one reference bit per slot, packed 64 to a word, set on insert and
+// on every hit. The hand sweeps forward clearing set bits until it finds a
+// clear one; a word of set bits is cleared in one step and the first clear
+// bit found with count-trailing-zeros.
+struct Clock {
+    template <class Key, class Hash>
+    struct State {
+        std::vector<uint64_t> ref;
+        int capacity, hand = 0;
+
+        State(int capacity, const Hash &) : ref((capacity + 63) / 64, 0), capacity(capacity) {}
+        void mark(int slot) { ref[slot >> 6] |= 1ULL << (slot & 63); }
+        void touch(int slot) { mark(slot); }
+        int miss(const Key &, bool full, const Key *) { return full ? sweep() : -1; }
+        void insert(int slot, const Key &) { mark(slot); }
+        void erase(int slot) { ref[slot >> 6] &= ~(1ULL << (slot & 63)); }
+        int sweep() {
+            while (true) {
+                int w = hand >> 6, b = hand & 63;
+                uint64_t below = b ? (1ULL << b) - 1 : 0;          // slots behind the hand
+                int live = std::min(64, capacity - w * 64);
+                uint64_t valid = live == 64 ? ~0ULL : (1ULL << live) - 1;
+                uint64_t clear = ~ref[w] & valid & ~below;
+                if (clear) {
+                    int bit = __builtin_ctzll(clear);
+                    ref[w] &= ~(((1ULL << bit) - 1) & ~below);     // second chances used up
+                    int slot = w * 64 + bit;
+                    hand = slot + 1 == capacity ? 0 : slot + 1;
+                    return slot;
+                }
+                ref[w] &= below;
+                hand = (w + 1) * 64 >= capacity ? 0 : (w + 1) * 64;
+            }
+        }
+    };
+};
+
+// ARC (Megiddo & Modha): T1 holds entries used once recently, T2 entries
+// used at least twice; the ghost lists B1/B2 remember the keys recently
+// evicted from each. A miss that hits B1 means T1 was too small, so its
+// target size p grows, and a hit in B2 shrinks it. Ghosts keep their own
+// keys and index (at most capacity + 1 of them while a ghost is promoted).
+struct Arc {
+    template <class Key, class Hash>
+    struct State {
+        enum { T1, T2 };
+        Links links;                     // T1 / T2 over cache slots
+        List t[2];
+        std::vector<uint8_t> in;
+        std::vector<Key> ghostKeys;      // B1 / B2 over ghost nodes
+        std::vector<uint32_t> ghostHashes;
+        std::vector<uint8_t> ghostIn;
+        std::vector<int32_t> freeGhosts;
+        Links ghostLinks;
+        List b[2];
+        FlatIndex<Key, Hash> ghostIndex;
+        int capacity, p = 0;
+        int pending = -1;                // ghost of the key being inserted
+
+        State(int capacity, const Hash &hasher)
+            : links(capacity), in(capacity), ghostKeys(capacity + 1), ghostHashes(capacity + 1),
+              ghostIn(capacity + 1), ghostLinks(capacity + 1), ghostIndex(capacity + 1, hasher),
+              capacity(capacity) {
+            for (int g = capacity; g >= 0; g--) freeGhosts.push_back(g);
+        }
+        void touch(int slot) {
+            t[in[slot]].unlink(links, slot);
+            t[T2].pushFront(links, slot);
+            in[slot] = T2;
+        }
+        void addGhost(int list, const Key &key) {
+            int g = freeGhosts.back();
+            freeGhosts.pop_back();
+            ghostKeys[g] = key;
+            ghostHashes[g] = ghostIndex.hash(key);
+            ghostIndex.insert(ghostHashes[g], g);
+            b[list].pushFront(ghostLinks, g);
+            ghostIn[g] = list;
+        }
+        void dropGhost(int g) {
+            b[ghostIn[g]].unlink(ghostLinks, g);
+            ghostIndex.erase(ghostHashes[g], g);
+            freeGhosts.push_back(g);
+        }
+        // Evicts the LRU entry of T1 or T2 into the matching ghost list
+        int replace(bool inB2, const Key *keys) {
+            int t1 = t[T1].size;
+            int from = t1 > 0 && (t1 > p || (inB2 && t1 == p)) ? T1 : T2;
+            int slot = t[from].tail;
+            t[from].unlink(links, slot);
+            addGhost(from, keys[slot]);
+            return slot;
+        }
+        int miss(const Key &key, bool full, const Key *keys) {
+            int g = ghostIndex.find(key, ghostIndex.hash(key), ghostKeys.data());
+            if (g >= 0) {
+                bool inB1 = ghostIn[g] == T1;
+                int b1 = b[T1].size, b2 = b[T2].size;
+                if (inB1) p = std::min(capacity, p + std::max(b2 / b1, 1));
+                else p = std::max(0, p - std::max(b1 / b2, 1));
+                pending = g;
+                return full ? replace(!inB1, keys) : -1;
+            }
+            int l1 = t[T1].size + b[T1].size;
+            int total = l1 + t[T2].size + b[T2].size;
+            if (l1 == capacity) {
+                if (t[T1].size < capacity) {
+                    dropGhost(b[T1].tail);
+                } else {                 // T1 alone fills the cache: evict without a ghost
+                    int slot = t[T1].tail;
+                    t[T1].unlink(links, slot);
+                    return slot;
+                }
+            } else if (total == 2 * capacity) {
+                dropGhost(b[T2].tail);
+            }
+            return full ? replace(false, keys) : -1;
+        }
+        void insert(int slot, const Key &) {
+            int list = T1;
+            if (pending >= 0) {
+                dropGhost(pending);
+                pending = -1;
+                list = T2;
+            }
+            t[list].pushFront(links, slot);
+            in[slot] = list;
+        }
+        void erase(int slot) { t[in[slot]].unlink(links, slot); }
+    };
+};
+
+template <class Key, class Value, class Policy, class Hash = std::hash<Key>>
+class Cache {
+    std::vector<Key> keys_;
+    std::vector<Value> values_;
+    std::vector<uint32_t> hashes_;
+    std::vector<uint8_t> live_;
+    std::vector<int32_t> free_;
+    FlatIndex<Key, Hash> index_;
+    typename Policy::template State<Key, Hash> policy_;
+    int capacity_, size_ = 0;
+    bool indexed_;
+
+    template <class OnEvict>
+    int insertHashed(const Key &key, uint32_t h, Value &&value, OnEvict &&onEvict) {
+        int slot = policy_.miss(key, size_ == capacity_, keys_.data());
+        if (slot >= 0) {
+            onEvict(keys_[slot], values_[slot]);
+            if (indexed_) index_.erase(hashes_[slot], slot);
+        } else {
+            slot = free_.back();
+            free_.pop_back();
+            live_[slot] = 1;
+            size_++;
+        }
+        keys_[slot] = key;
+        values_[slot] = std::move(value);
+        hashes_[slot] = h;
+        if (indexed_) index_.insert(h, slot);
+        policy_.insert(slot, key);
+        return slot;
+    }
+    int findHashed(const Key &key, uint32_t h) const {
+        if (indexed_) return index_.find(key, h, keys_.data());
+        for (int s = 0; s < capacity_; s++)
+            if (live_[s] && keys_[s] == key) return s;
+        return -1;
+    }
+
+public:
+    // capacity >= 1; Key and Value must be default-constructible. A small
+    // cache (a few dozen entries) can skip the index: find() is then a
+    // linear scan, which beats hashing at that size.
+    explicit Cache(int capacity, const Hash &hasher = Hash(), bool indexed = true)
+        : keys_(capacity), values_(capacity), hashes_(capacity), live_(capacity, 0),
+          index_(indexed ? capacity : 0, hasher), policy_(capacity, hasher), capacity_(capacity),
+          indexed_(indexed) {
+        free_.reserve(capacity);
+        for (int s = capacity - 1; s >= 0; s--) free_.push_back(s);
+    }
+
+    int size() const { return size_; }
+    int capacity() const { return capacity_; }
+
+    // Slot holding key, or -1. Does not count as a use.
+    int find(const Key &key) const { return findHashed(key, index_.hash(key)); }
+    bool contains(const Key &key) const { return find(key) >= 0; }
+    const Value *peek(const Key &key) const {
+        int s = find(key);
+        return s >= 0 ? &values_[s] : nullptr;
+    }
+    // Records a use of the entry in slot (from find)
+    void touch(int slot) { policy_.touch(slot); }
+    Value *get(const Key &key) {
+        int s = find(key);
+        if (s < 0) return nullptr;
+        policy_.touch(s);
+        return &values_[s];
+    }
+
+    // Inserts or updates key (an update counts as a use) and returns its
+    // slot. onEvict(key, value) sees the victim before its slot is reused.
+    template <class OnEvict>
+    int put(const Key &key, Value value, OnEvict &&onEvict) {
+        uint32_t h = index_.hash(key);
+        int s = findHashed(key, h);
+        if (s >= 0) {
+            values_[s] = std::move(value);
+            policy_.touch(s);
+            return s;
+        }
+        return insertHashed(key, h, std::move(value), onEvict);
+    }
+    int put(const Key &key, Value value) {
+        return put(key, std::move(value), [](const Key &, Value &) {});
+    }
+    // put() for a key known to be absent (after a failed get), skipping the lookup
+    template <class OnEvict>
+    int insert(const Key &key, Value value, OnEvict &&onEvict) {
+        return insertHashed(key, index_.hash(key), std::move(value), onEvict);
+    }
+    int insert(const Key &key, Value value) {
+        return insert(key, std::move(value), [](const Key &, Value &) {});
+    }
+    bool erase(const Key &key) {
+        int s = find(key);
+        if (s < 0) return false;
+        policy_.erase(s);
+        if (indexed_) index_.erase(hashes_[s], s);
+        live_[s] = 0;
+        free_.push_back(s);
+        size_--;
+        return true;
+    }
+
+    // Slot-indexed access. Slots fill from 0 and are reused only by eviction,
+    // so without erase() slots [0, size()) are exactly the live entries.
+    const Key *keys() const { return keys_.data(); }
+    const Key &keyAt(int slot) const { return keys_[slot]; }
+    Value &valueAt(int slot) { return values_[slot]; }
+    const typename Policy::template State<Key, Hash> &policy() const { return policy_; }
+};
+
+// A trivially copyable value kept as relaxed atomic 64-bit words, so a
+// seqlock reader may load it while a writer stores it: the reader sees a
+// torn copy, notices the sequence change and retries (Boehm, "Can seqlocks
+// get along with programming language memory models?").
+template <class T>
+class AtomicWords {
+    static_assert(std::is_trivially_copyable<T>::value, "seqlock data must be trivially copyable");
+    static constexpr size_t N = (sizeof(T) + 7) / 8;
+    std::atomic<uint64_t> words[N];
+
+public:
+    AtomicWords() {
+        for (auto &w : words) w.store(0, std::memory_order_relaxed);
+    }
+    void store(const T &v) {
+        uint64_t buf[N] = {};
+        std::memcpy(buf, &v, sizeof(T));
+        for (size_t i = 0; i < N; i++) words[i].store(buf[i], std::memory_order_relaxed);
+    }
+    T load() const {
+        uint64_t buf[N];
+        for (size_t i = 0; i < N; i++) buf[i] = words[i].load(std::memory_order_relaxed);
+        T v;
+        std::memcpy(&v, buf, sizeof(T));
+        return v;
+    }
+};
+
+// CLOCK cache for many threads. Keys are spread over `shards` (a power of
+// two) independent shards by hash, each with its own slots, index, hand and
+// mutex. get() takes no lock: it reads the shard optimistically under a
+// sequence counter (odd while a writer is inside) and retries if a writer
+// got in the way, falling back to the mutex after a few tries. A hit sets
+// the slot's reference bit with an atomic OR, and only when it is clear, so
+// hot keys do not bounce the bit's cache line between cores. A racing bit
+// can land on a slot just being refilled; CLOCK only loses a little
+// precision from that. put() and erase() lock the shard and do the index
+// update and the CLOCK sweep there. Key and Value must be trivially
+// copyable and default-constructible.
+template <class Key, class Value, class Hash = std::hash<Key>>
+class ConcurrentClockCache {
+    struct alignas(64) Shard {
+        std::mutex lock;
+        std::atomic<uint64_t> seq{0};
+        std::vector<std::atomic<uint64_t>> buckets;   // hash << 32 | (slot + 1); 0: empty
+        std::vector<AtomicWords<Key>> keys;
+        std::vector<AtomicWords<Value>> values;
+        std::vector<std::atomic<uint64_t>> ref;       // CLOCK bits, 64 slots a word
+        std::atomic<int> entries{0};                  // for size() without the lock
+        std::vector<uint32_t> hashes;                 // below: writers only
+        std::vector<int32_t> freeSlots;
+        int capacity = 0, used = 0, hand = 0;
+        size_t mask = 0;
+
+        void init(int cap) {
+            capacity = cap;
+            size_t n = 8;
+            while (n < 2 * (size_t)cap) n <<= 1;
+            buckets = std::vector<std::atomic<uint64_t>>(n);
+            for (auto &b : buckets) b.store(0, std::memory_order_relaxed);
+            mask = n - 1;
+            keys = std::vector<AtomicWords<Key>>(cap);
+            values = std::vector<AtomicWords<Value>>(cap);
+            ref = std::vector<std::atomic<uint64_t>>((cap + 63) / 64);
+            for (auto &w : ref) w.store(0, std::memory_order_relaxed);
+            hashes.assign(cap, 0);
+            freeSlots.reserve(cap);
+        }
+        // Probe for key. Under a racing writer the result may be wrong (the
+        // caller validates seq); the probe is bounded so it always ends.
+        int find(const Key &key, uint32_t h) const {
+            for (size_t i = h & mask, n = 0; n <= mask; i = (i + 1) & mask, n++) {
+                uint64_t b = buckets[i].load(std::memory_order_relaxed);
+                if (!b) return -1;
+                int slot = (int)(uint32_t)b - 1;
+                if ((uint32_t)(b >> 32) == h && slot < capacity && keys[slot].load() == key) return slot;
+            }
+            return -1;
+        }
+        void mark(int slot) {
+            std::atomic<uint64_t> &w = ref[slot >> 6];
+            uint64_t bit = 1ULL << (slot & 63);
+            if (!(w.load(std::memory_order_relaxed) & bit)) w.fetch_or(bit, std::memory_order_relaxed);
+        }
+        void beginWrite() {
+            seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
+        void endWrite() { seq.store(seq.load(std::memory_order_relaxed) + 1, std::memory_order_release); }
+
+        void indexInsert(uint32_t h, int slot) {
+            size_t i = h & mask;
+            while (buckets[i].load(std::memory_order_relaxed)) i = (i + 1) & mask;
+            buckets[i].store((uint64_t)h << 32 | (uint32_t)(slot + 1), std::memory_order_relaxed);
+        }
+        void indexErase(uint32_t h, int slot) {
+            size_t i = h & mask;
+            while ((int)(uint32_t)buckets[i].load(std::memory_order_relaxed) != slot + 1) i = (i + 1) & mask;
+            for (size_t j = (i + 1) & mask;; j = (j + 1) & mask) {
+                uint64_t b = buckets[j].load(std::memory_order_relaxed);
+                if (!b) break;
+                size_t home = (b >> 32) & mask;
+                if (((j - home) & mask) >= ((j - i) & mask)) {
+                    buckets[i].store(b, std::memory_order_relaxed);
+                    i = j;
+                }
+            }
+            buckets[i].store(0, std::memory_order_relaxed);
+        }
+        // The CLOCK sweep of cachelib::Clock on atomic words. Readers keep
+        // setting bits meanwhile, so after two full turns the slot under the
+        // hand is taken regardless.
+        int sweep() {
+            int words = (capacity + 63) / 64;
+            for (int turns = 0;; turns++) {
+                int w = hand >> 6, b = hand & 63;
+                if (turns > 2 * words) {
+                    int slot = hand;
+                    hand = slot + 1 == capacity ? 0 : slot + 1;
+                    return slot;
+                }
+                uint64_t below = b ? (1ULL << b) - 1 : 0;
+                int live = std::min(64, capacity - w * 64);
+                uint64_t valid = live == 64 ? ~0ULL : (1ULL << live) - 1;
+                uint64_t clear = ~ref[w].load(std::memory_order_relaxed) & valid & ~below;
+                if (clear) {
+                    int bit = __builtin_ctzll(clear);
+                    ref[w].fetch_and(~(((1ULL << bit) - 1) & ~below), std::memory_order_relaxed);
+                    int slot = w * 64 + bit;
+                    hand = slot + 1 == capacity ? 0 : slot + 1;
+                    return slot;
+                }
+                ref[w].fetch_and(below, std::memory_order_relaxed);
+                hand = (w + 1) * 64 >= capacity ? 0 : (w + 1) * 64;
+            }
+        }
+    };
+
+    std::unique_ptr<Shard[]> shards_;
+    int shardMask_, capacity_;
+    Hash hasher_;
+
+    uint64_t mix(const Key &key) const { return (uint64_t)hasher_(key) * 0x9E3779B97F4A7C15ULL; }
+    // Shard from bits 24-31 of the mixed hash, bucket hash from the top 32
+    Shard &shardOf(uint64_t h) const { return shards_[(h >> 24) & shardMask_]; }
+
+public:
+    // capacity is split evenly over shards (rounded up to a power of two, at most 256)
+    explicit ConcurrentClockCache(int capacity, int shards = 64, const Hash &hasher = Hash())
+        : hasher_(hasher) {
+        int n = 1;
+        while (n < shards && n < 256) n <<= 1;
+        shards_.reset(new Shard[n]);
+        shardMask_ = n - 1;
+        int per = std::max(1, (capacity + n - 1) / n);
+        for (int i = 0; i < n; i++) shards_[i].init(per);
+        capacity_ = per * n;
+    }
+
+    int capacity() const { return capacity_; }
+    int shards() const { return shardMask_ + 1; }
+
+    bool get(const Key &key, Value &out) {
+        uint64_t h = mix(key);
+        Shard &s = shardOf(h);
+        uint32_t hh = h >> 32;
+        for (int attempt = 0; attempt < 4; attempt++) {
+            uint64_t seq = s.seq.load(std::memory_order_acquire);
+            if (seq & 1) continue;
+            int slot = s.find(key, hh);
+            Value v{};
+            if (slot >= 0) v = s.values[slot].load();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (s.seq.load(std::memory_order_relaxed) != seq) continue;
+            if (slot < 0) return false;
+            s.mark(slot);
+            out = v;
+            return true;
+        }
+        std::lock_guard<std::mutex> guard(s.lock);    // writers kept the shard busy
+        int slot = s.find(key, hh);
+        if (slot < 0) return false;
+        s.mark(slot);
+        out = s.values[slot].load();
+        return true;
+    }
+
+    // Inserts or updates key, evicting by CLOCK within its shard
+    void put(const Key &key, const Value &value) {
+        uint64_t h = mix(key);
+        Shard &s = shardOf(h);
+        uint32_t hh = h >> 32;
+        std::lock_guard<std::mutex> guard(s.lock);
+        s.beginWrite();
+        int slot = s.find(key, hh);
+        if (slot < 0) {
+            if (!s.freeSlots.empty()) {
+                slot = s.freeSlots.back();
+                s.freeSlots.pop_back();
+                s.entries.fetch_add(1, std::memory_order_relaxed);
+            } else if (s.used < s.capacity) {
+                slot = s.used++;
+                s.entries.fetch_add(1, std::memory_order_relaxed);
+            } else {
+                slot = s.sweep();
+                s.indexErase(s.hashes[slot], slot);
+            }
+            s.keys[slot].store(key);
+            s.hashes[slot] = hh;
+            s.indexInsert(hh, slot);
+        }
+        s.values[slot].store(value);
+        s.mark(slot);
+        s.endWrite();
+    }
+
+    bool erase(const Key &key) {
+        uint64_t h = mix(key);
+        Shard &s = shardOf(h);
+        std::lock_guard<std::mutex> guard(s.lock);
+        int slot = s.find(key, h >> 32);
+        if (slot < 0) return false;
+        s.beginWrite();
+        s.indexErase(s.hashes[slot], slot);
+        s.ref[slot >> 6].fetch_and(~(1ULL << (slot & 63)), std::memory_order_relaxed);
+        s.freeSlots.push_back(slot);
+        s.entries.fetch_sub(1, std::memory_order_relaxed);
+        s.endWrite();
+        return true;
+    }
+
+    // Entries in the cache. Safe to call during writes; the sum is then a
+    // snapshot that may be off by the entries being put or erased meanwhile.
+    int size() const {
+        int n = 0;
+        for (int i = 0; i <= shardMask_; i++) n += shards_[i].entries.load(std::memory_order_relaxed);
+        return n;
+    }
+};
+
+}  // namespace cachelib
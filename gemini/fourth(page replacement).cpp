@@ -2,132 +2,3244 @@
 Write a program to simulate Page replacement algorithm
 */
 #include <bits/stdc++.h>
+#include <ext/pb_ds/assoc_container.hpp>
+#include <ext/pb_ds/tree_policy.hpp>
+#include <fcntl.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "cache.h"
 using namespace std;
 
+// Page numbers are 64-bit so traces from large address spaces fit. Every
+// simulation takes its reference string as any iterable range of page
+// numbers: a vector<int> literal or a TraceReader streaming a trace file.
+using Page = long long;
+
+// A reference that also says whether it writes the page (write-back model).
+// Plain page numbers convert as reads.
+struct Ref {
+    Page page;
+    bool write;
+};
+inline Ref asRef(Page page) { return {page, false}; }
+inline Ref asRef(Ref r) { return r; }
+
 // Function to display page frames
-void display(vector<int> frames) {
-    for (int f : frames)
+void display(const vector<Page> &frames) {
+    for (Page f : frames)
         cout << f << " ";
     cout << "\n";
 }
 
-// FIFO Page Replacement
-void fifo(vector<int> pages, int capacity) {
-    cout << "\n=== FIFO Page Replacement ===\n";
-    vector<int> frames;
-    queue<int> q;
-    int faults = 0;
+// Residency check for small frame sets: index of `page` in frames[0, n), or
+// -1. The vector versions compare 2 (SSE4.1) or 4 (AVX2) frames per
+// instruction; findFrame is bound once at startup to the best one the CPU
+// supports, with the scalar loop as the fallback (a benchmark may rebind it).
+int findFrameScalar(const Page *frames, int n, Page page) {
+    for (int i = 0; i < n; i++)
+        if (frames[i] == page) return i;
+    return -1;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+// Each 64-frame chunk is compared without branches into a one-bit-per-frame
+// mask; only the chunk result is tested, so a hit's position does not cost a
+// mispredicted loop exit.
+__attribute__((target("sse4.1"))) int findFrameSse4(const Page *frames, int n, Page page) {
+    __m128i key = _mm_set1_epi64x(page);
+    for (int base = 0; base < n; base += 64) {
+        int len = min(64, n - base), i = 0;
+        const Page *f = frames + base;
+        uint64_t mask = 0;
+        for (; i + 2 <= len; i += 2) {
+            __m128i eq = _mm_cmpeq_epi64(_mm_loadu_si128((const __m128i *)(f + i)), key);
+            mask |= (uint64_t)_mm_movemask_pd(_mm_castsi128_pd(eq)) << i;
+        }
+        if (i < len) mask |= (uint64_t)(f[i] == page) << i;
+        if (mask) return base + __builtin_ctzll(mask);
+    }
+    return -1;
+}
+
+__attribute__((target("avx2"))) int findFrameAvx2(const Page *frames, int n, Page page) {
+    __m256i key = _mm256_set1_epi64x(page);
+    for (int base = 0; base < n; base += 64) {
+        int len = min(64, n - base), i = 0;
+        const Page *f = frames + base;
+        uint64_t mask = 0;
+        for (; i + 4 <= len; i += 4) {
+            __m256i eq = _mm256_cmpeq_epi64(_mm256_loadu_si256((const __m256i *)(f + i)), key);
+            mask |= (uint64_t)_mm256_movemask_pd(_mm256_castsi256_pd(eq)) << i;
+        }
+        for (; i < len; i++) mask |= (uint64_t)(f[i] == page) << i;
+        if (mask) return base + __builtin_ctzll(mask);
+    }
+    return -1;
+}
+#endif
+
+using FindFrameFn = int (*)(const Page *, int, Page);
+FindFrameFn pickFindFrame() {
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) return findFrameAvx2;
+    if (__builtin_cpu_supports("sse4.1")) return findFrameSse4;
+#endif
+    return findFrameScalar;
+}
+FindFrameFn findFrame = pickFindFrame();
+
+// Engines with at most this many frames look pages up with findFrame
+// instead of the hash index. Past about 16 frames the O(1) index wins even
+// against AVX2 (see bench(page replacement).cpp).
+int scanFrameLimit = 16;
+
+// Open-addressing page -> frame index (linear probing, backward-shift delete).
+// Sized once to at least twice the frame count, so it never rehashes.
+struct PageIndex {
+    vector<Page> keys;
+    vector<int> vals;                // vals[i] == -1 marks an empty bucket
+    size_t mask;
+    int shift;
+
+    explicit PageIndex(size_t capacity) {
+        size_t n = 8;
+        shift = 61;
+        while (n < 2 * capacity) n <<= 1, shift--;
+        keys.assign(n, 0);
+        vals.assign(n, -1);
+        mask = n - 1;
+    }
+    // Fibonacci hashing: top bits of the product spread strided page numbers
+    size_t home(Page page) const {
+        return (size_t)(((uint64_t)page * 0x9E3779B97F4A7C15ULL) >> shift);
+    }
+    int find(Page page) const {
+        for (size_t i = home(page);; i = (i + 1) & mask) {
+            if (vals[i] < 0) return -1;
+            if (keys[i] == page) return vals[i];
+        }
+    }
+    void insert(Page page, int frame) {
+        size_t i = home(page);
+        while (vals[i] >= 0 && keys[i] != page) i = (i + 1) & mask;
+        keys[i] = page;
+        vals[i] = frame;
+    }
+    void erase(Page page) {
+        size_t i = home(page);
+        while (keys[i] != page || vals[i] < 0) {
+            if (vals[i] < 0) return;
+            i = (i + 1) & mask;
+        }
+        // Shift later members of the probe run back so lookups never stop early
+        for (size_t j = (i + 1) & mask; vals[j] >= 0; j = (j + 1) & mask) {
+            size_t h = home(keys[j]);
+            if (((j - h) & mask) >= ((j - i) & mask)) {
+                keys[i] = keys[j];
+                vals[i] = vals[j];
+                i = j;
+            }
+        }
+        vals[i] = -1;
+    }
+};
+
+// The LRU, MRU, FIFO, CLOCK and ARC engines are the replacement policies of
+// the cache library (cache.h) behind the simulator's frame interface:
+// access() reports hit or fault, `slot` is the frame of the last referenced
+// page and pages() lists the frames. A cache slot is a frame; slots fill in
+// order and are reused only by eviction, so the frames print in place. With
+// `scan` (small frame sets) the cache runs unindexed and residency is a
+// findFrame over its contiguous keys.
+template <class Policy>
+struct CacheFrames {
+    struct Empty {};
+    cachelib::Cache<Page, Empty, Policy> cache;
+    int slot = -1;                   // frame of the last referenced page
+    bool scan;
+
+    explicit CacheFrames(int capacity)
+        : cache(capacity, hash<Page>(), capacity > scanFrameLimit), scan(capacity <= scanFrameLimit) {}
+
+    bool access(Page page) {
+        slot = scan ? findFrame(cache.keys(), cache.size(), page) : cache.find(page);
+        if (slot >= 0) {
+            cache.touch(slot);
+            return true;
+        }
+        slot = cache.insert(page, Empty());
+        return false;
+    }
+    // Residency test that leaves the policy state alone
+    bool contains(Page page) const {
+        return (scan ? findFrame(cache.keys(), cache.size(), page) : cache.find(page)) >= 0;
+    }
+    vector<Page> pages() const { return vector<Page>(cache.keys(), cache.keys() + cache.size()); }
+};
+
+// ARC lists its pages as T1 then T2, most recent first
+template <>
+vector<Page> CacheFrames<cachelib::Arc>::pages() const {
+    auto &st = cache.policy();
+    vector<Page> out;
+    for (auto &list : st.t)
+        for (int s = list.head; s >= 0; s = st.links.next[s]) out.push_back(cache.keyAt(s));
+    return out;
+}
+
+// MRU: the library's LRU order with the victim taken from the recent end
+struct Mru {
+    template <class Key, class Hash>
+    struct State : cachelib::Lru::State<Key, Hash> {
+        using cachelib::Lru::State<Key, Hash>::State;
+        int miss(const Key &, bool full, const Key *) {
+            if (!full) return -1;
+            int victim = this->order.head;
+            this->order.unlink(this->links, victim);
+            return victim;
+        }
+    };
+};
+
+using LruFrames = CacheFrames<cachelib::Lru>;
+using MruFrames = CacheFrames<Mru>;
+using FifoFrames = CacheFrames<cachelib::Fifo>;
+using ClockFrames = CacheFrames<cachelib::Clock>;
+using ArcFrames = CacheFrames<cachelib::Arc>;
+
+// Buffered binary output: bytes collect in a 1 MiB buffer that goes out in
+// one fwrite when full, so per-record writes cost a memcpy
+class BufferedWriter {
+    FILE *f;
+    vector<uint8_t> buf;
+
+public:
+    explicit BufferedWriter(const string &path) : f(fopen(path.c_str(), "wb")) { buf.reserve(1 << 20); }
+    ~BufferedWriter() { finish(); }
+    BufferedWriter(const BufferedWriter &) = delete;
+    BufferedWriter &operator=(const BufferedWriter &) = delete;
+
+    bool ok() const { return f != nullptr; }
+    void put(const void *data, size_t n) {
+        if (buf.size() + n > buf.capacity()) flush();
+        buf.insert(buf.end(), (const uint8_t *)data, (const uint8_t *)data + n);
+    }
+    void putByte(uint8_t b) {
+        if (buf.size() == buf.capacity()) flush();
+        buf.push_back(b);
+    }
+    void flush() {
+        if (f && !buf.empty()) fwrite(buf.data(), 1, buf.size(), f);
+        buf.clear();
+    }
+    // Overwrite already-written bytes, e.g. a count in a header
+    void patch(long offset, const void *data, size_t n) {
+        flush();
+        if (!f) return;
+        long here = ftell(f);
+        fseek(f, offset, SEEK_SET);
+        fwrite(data, 1, n, f);
+        fseek(f, here, SEEK_SET);
+    }
+    bool finish() {
+        if (!f) return false;
+        flush();
+        bool good = !ferror(f);
+        good &= fclose(f) == 0;
+        f = nullptr;
+        return good;
+    }
+};
+
+// Event sinks receive every reference of a simulation: start(name), then
+// record(page, hit, frames) per reference, then finish(). All of them count
+// hits and faults; the default sink does nothing else, so the hot loop has
+// no I/O at all.
+struct CountSink {
+    long long hits = 0, faults = 0;
+    void start(const string &) { hits = faults = 0; }
+    template <class Frames>
+    void record(Page, bool hit, const Frames &) { hit ? hits++ : faults++; }
+    void finish() {}
+};
+
+// Debug mode: the per-reference text trace, one line and a frame listing
+// per reference. Only meant for small examples.
+struct TextSink : CountSink {
+    void start(const string &name) {
+        CountSink::start(name);
+        cout << "\n=== " << name << " Page Replacement ===\n";
+    }
+    template <class Frames>
+    void record(Page page, bool hit, const Frames &frames) {
+        CountSink::record(page, hit, frames);
+        if (hit) {
+            cout << "Page " << page << " -> No page fault\n";
+        } else {
+            cout << "Page " << page << " -> ";
+            display(frames.pages());
+        }
+    }
+    void finish() { cout << "Total Page Faults = " << faults << "\n"; }
+};
+
+// Binary event log (.pgev), one simulation per file. Header, 16 bytes
+// little-endian: char magic[4] "PGEV", uint16 version 1, uint16 reserved 0,
+// uint64 count. Body: one uint64 per reference, (page << 1) | 1 on a fault
+// and (page << 1) on a hit.
+struct EventLogSink : CountSink {
+    BufferedWriter out;
+    uint64_t count = 0;
+
+    explicit EventLogSink(const string &path) : out(path) {}
+
+    bool ok() const { return out.ok(); }
+    void start(const string &name) {
+        CountSink::start(name);
+        count = 0;
+        const char header[16] = {'P', 'G', 'E', 'V', 1};
+        out.put(header, sizeof header);     // count is patched in by finish()
+    }
+    template <class Frames>
+    void record(Page page, bool hit, const Frames &frames) {
+        CountSink::record(page, hit, frames);
+        uint64_t e = (uint64_t)page << 1 | !hit;
+        out.put(&e, sizeof e);
+        count++;
+    }
+    void finish() {
+        out.patch(8, &count, sizeof count);
+        out.flush();
+    }
+};
+
+// Runs a frame engine (anything with access() and pages()) over a trace,
+// reporting each reference to the sink. Returns the number of faults.
+template <class Frames, class Range, class Sink>
+long long simulate(const string &name, Frames &frames, const Range &pages, Sink &sink) {
+    sink.start(name);
+    for (Page p : pages) sink.record(p, frames.access(p), frames);
+    sink.finish();
+    return sink.faults;
+}
+
+// Same loop without output, for large comparisons
+template <class Frames, class Range>
+long long countFaults(Frames &frames, const Range &pages) {
+    long long faults = 0;
+    for (Page p : pages) faults += !frames.access(p);
+    return faults;
+}
+
+// The drivers below count by default; pass a TextSink for the old
+// reference-by-reference listing or an EventLogSink for a binary log.
+
+// LRU Page Replacement
+template <class Range, class Sink = CountSink>
+long long lru(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    LruFrames frames(capacity);
+    return simulate("LRU", frames, pages, sink);
+}
+
+// MRU Page Replacement (evicts the most recently used page)
+template <class Range, class Sink = CountSink>
+long long mru(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    MruFrames frames(capacity);
+    return simulate("MRU", frames, pages, sink);
+}
+
+// FIFO Page Replacement
+template <class Range, class Sink = CountSink>
+long long fifo(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    FifoFrames frames(capacity);
+    return simulate("FIFO", frames, pages, sink);
+}
+
+// Second chance: the FIFO-queue formulation of CLOCK. The oldest frame is
+// evicted unless its bit is set, in which case the bit is cleared and the
+// frame goes to the back of the queue. Same victims as ClockFrames.
+struct SecondChanceFrames {
+    vector<Page> frames;
+    vector<bool> ref;
+    deque<int> order;                // frame slots, oldest first
+    int capacity, slot = -1;
+    bool scan;
+    PageIndex where;
+
+    explicit SecondChanceFrames(int capacity)
+        : frames(capacity), ref(capacity), capacity(capacity), scan(capacity <= scanFrameLimit),
+          where(scan ? 0 : capacity) {}
+
+    bool access(Page page) {
+        int f = scan ? findFrame(frames.data(), order.size(), page) : where.find(page);
+        if (f >= 0) {
+            ref[f] = true;
+            slot = f;
+            return true;
+        }
+        if ((int)order.size() < capacity) {
+            f = order.size();
+        } else {
+            while (ref[order.front()]) {
+                ref[order.front()] = false;
+                order.push_back(order.front());
+                order.pop_front();
+            }
+            f = order.front();
+            order.pop_front();
+            if (!scan) where.erase(frames[f]);
+        }
+        frames[f] = page;
+        ref[f] = true;
+        order.push_back(f);
+        if (!scan) where.insert(page, f);
+        slot = f;
+        return false;
+    }
+    vector<Page> pages() const { return vector<Page>(frames.begin(), frames.begin() + order.size()); }
+};
+
+// GCLOCK: a counter per frame instead of a bit. A hit adds one (up to
+// maxCount), a load starts at one; the hand decrements counters as it passes
+// and takes the first frame already at zero.
+struct GClockFrames {
+    vector<Page> frames;
+    vector<uint8_t> count;
+    int capacity, used = 0, hand = 0, slot = -1;
+    uint8_t maxCount;
+    bool scan;
+    PageIndex where;
+
+    explicit GClockFrames(int capacity, int maxCount = 3)
+        : frames(capacity), count(capacity), capacity(capacity), maxCount(maxCount),
+          scan(capacity <= scanFrameLimit), where(scan ? 0 : capacity) {}
+
+    bool access(Page page) {
+        int f = scan ? findFrame(frames.data(), used, page) : where.find(page);
+        if (f >= 0) {
+            if (count[f] < maxCount) count[f]++;
+            slot = f;
+            return true;
+        }
+        if (used < capacity) {
+            f = used++;
+        } else {
+            while (count[hand] > 0) {
+                count[hand]--;
+                hand = hand + 1 == capacity ? 0 : hand + 1;
+            }
+            f = hand;
+            hand = hand + 1 == capacity ? 0 : hand + 1;
+            if (!scan) where.erase(frames[f]);
+        }
+        frames[f] = page;
+        count[f] = 1;
+        if (!scan) where.insert(page, f);
+        slot = f;
+        return false;
+    }
+    vector<Page> pages() const { return vector<Page>(frames.begin(), frames.begin() + used); }
+};
+
+// CLOCK Page Replacement
+template <class Range, class Sink = CountSink>
+long long clockReplacement(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    ClockFrames frames(capacity);
+    return simulate("CLOCK", frames, pages, sink);
+}
+
+// Second Chance Page Replacement
+template <class Range, class Sink = CountSink>
+long long secondChance(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    SecondChanceFrames frames(capacity);
+    return simulate("Second Chance", frames, pages, sink);
+}
+
+// GCLOCK Page Replacement
+template <class Range, class Sink = CountSink>
+long long gclock(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    GClockFrames frames(capacity);
+    return simulate("GCLOCK", frames, pages, sink);
+}
+
+// Write-back cost model: a page written while resident is dirty, and
+// evicting it costs a write on top of the read every fault costs
+struct IoCost {
+    double readSeconds = 100e-6, writeSeconds = 200e-6;
+};
+
+struct WriteBackStats {
+    long long refs = 0, writes = 0, faults = 0, cleanEvictions = 0, dirtyEvictions = 0;
+    long long dirtyResident = 0;     // still dirty at the end (flushed at shutdown, not counted)
+    double ioSeconds(const IoCost &io) const {
+        return faults * io.readSeconds + dirtyEvictions * io.writeSeconds;
+    }
+};
+
+// Dirty tracking for any engine that reports the frame slot of each
+// reference: a dirty and a loaded bit per slot, packed 64 to a word. A fault
+// into a loaded slot evicted that slot's previous page, clean or dirty.
+template <class Frames>
+struct WriteBack {
+    Frames frames;
+    vector<uint64_t> dirty, loaded;
+    WriteBackStats stats;
+
+    WriteBack(Frames frames, int capacity)
+        : frames(move(frames)), dirty((capacity + 63) / 64), loaded((capacity + 63) / 64) {}
+
+    bool access(Page page, bool write) {
+        bool hit = frames.access(page);
+        int f = frames.slot;
+        stats.refs++;
+        stats.writes += write;
+        if (!hit) {
+            stats.faults++;
+            if (f < 0) {                 // not loaded (OPT bypass): a write goes straight out
+                stats.dirtyEvictions += write;
+                return false;
+            }
+            uint64_t bit = 1ULL << (f & 63);
+            if (loaded[f >> 6] & bit) (dirty[f >> 6] & bit ? stats.dirtyEvictions : stats.cleanEvictions)++;
+            loaded[f >> 6] |= bit;
+            dirty[f >> 6] &= ~bit;
+        }
+        if (write) dirty[f >> 6] |= 1ULL << (f & 63);
+        return hit;
+    }
+    WriteBackStats result() const {
+        WriteBackStats r = stats;
+        for (uint64_t w : dirty) r.dirtyResident += __builtin_popcountll(w);
+        return r;
+    }
+};
+
+// Enhanced CLOCK (clean-first second chance): frames rank by (referenced,
+// dirty). The hand first looks for an unreferenced clean frame without
+// touching any bits, then for an unreferenced dirty one, clearing the
+// reference bits it passes; if both fail, every bit is clear by then and it
+// starts over. Both searches go a word of frames at a time.
+struct EnhancedClockFrames {
+    vector<Page> frames;
+    vector<uint64_t> ref, dirty;
+    int capacity, used = 0, hand = 0, slot = -1;
+    PageIndex where;
+    WriteBackStats stats;
+
+    explicit EnhancedClockFrames(int capacity)
+        : frames(capacity), ref((capacity + 63) / 64), dirty((capacity + 63) / 64), capacity(capacity),
+          where(capacity) {}
+
+    uint64_t valid(int w) const {
+        int live = min(64, capacity - w * 64);
+        return live == 64 ? ~0ULL : (1ULL << live) - 1;
+    }
+    // First frame at or after the hand, wrapping around, whose bit is set in
+    // pick(w) (the candidate mask of word w); -1 if none
+    template <class Pick>
+    int findFrom(Pick pick) const {
+        int words = ref.size(), w0 = hand >> 6, b = hand & 63;
+        if (uint64_t m = pick(w0) & (~0ULL << b)) return w0 * 64 + __builtin_ctzll(m);
+        for (int k = 1; k <= words; k++) {
+            int w = (w0 + k) % words;
+            uint64_t m = pick(w);
+            if (k == words) m &= b ? (1ULL << b) - 1 : 0;     // back at the hand's word
+            if (m) return w * 64 + __builtin_ctzll(m);
+        }
+        return -1;
+    }
+    void clearRefs(int from, int to) {   // frames [from, to)
+        while (from < to) {
+            int w = from >> 6, hi = min(64, to - w * 64);
+            uint64_t m = (hi == 64 ? ~0ULL : (1ULL << hi) - 1) & (~0ULL << (from & 63));
+            ref[w] &= ~m;
+            from = w * 64 + hi;
+        }
+    }
+    int victim() {
+        while (true) {
+            int f = findFrom([&](int w) { return ~ref[w] & ~dirty[w] & valid(w); });
+            if (f >= 0) return f;
+            f = findFrom([&](int w) { return ~ref[w] & dirty[w] & valid(w); });
+            if (f >= 0) {
+                if (f >= hand) {
+                    clearRefs(hand, f);
+                } else {
+                    clearRefs(hand, capacity);
+                    clearRefs(0, f);
+                }
+                return f;
+            }
+            fill(ref.begin(), ref.end(), 0);
+        }
+    }
+    bool access(Page page, bool write = false) {
+        stats.refs++;
+        stats.writes += write;
+        int f = where.find(page);
+        bool hit = f >= 0;
+        if (!hit) {
+            stats.faults++;
+            if (used < capacity) {
+                f = used++;
+                hand = used == capacity ? 0 : used;
+            } else {
+                f = victim();
+                hand = f + 1 == capacity ? 0 : f + 1;
+                uint64_t bit = 1ULL << (f & 63);
+                (dirty[f >> 6] & bit ? stats.dirtyEvictions : stats.cleanEvictions)++;
+                dirty[f >> 6] &= ~bit;
+                where.erase(frames[f]);
+            }
+            frames[f] = page;
+            where.insert(page, f);
+        }
+        ref[f >> 6] |= 1ULL << (f & 63);
+        if (write) dirty[f >> 6] |= 1ULL << (f & 63);
+        slot = f;
+        return hit;
+    }
+    WriteBackStats result() const {
+        WriteBackStats r = stats;
+        for (uint64_t w : dirty) r.dirtyResident += __builtin_popcountll(w);
+        return r;
+    }
+    vector<Page> pages() const { return vector<Page>(frames.begin(), frames.begin() + used); }
+};
+
+// Runs a write-back engine over a range of Ref (plain pages count as reads)
+template <class Engine, class Range>
+WriteBackStats writeBack(Engine &engine, const Range &refs) {
+    for (auto x : refs) {
+        Ref r = asRef(x);
+        engine.access(r.page, r.write);
+    }
+    return engine.result();
+}
+
+// Shared storage for the adaptive policies: every tracked page (resident or
+// ghost) is a node on exactly one of a few intrusive lists (front = most
+// recent), and one PageIndex maps a page to its node. Nodes come from a
+// preallocated pool, so no access allocates.
+struct PageLists {
+    struct Node { Page page; int prev, next; uint8_t list; bool ref; };
+    vector<Node> nodes;
+    vector<int> freeNodes;
+    int head[4], tail[4], size[4];
+    PageIndex where;
+
+    explicit PageLists(int maxNodes) : nodes(maxNodes), where(maxNodes) {
+        for (int i = maxNodes - 1; i >= 0; i--) freeNodes.push_back(i);
+        fill(head, head + 4, -1);
+        fill(tail, tail + 4, -1);
+        fill(size, size + 4, 0);
+    }
+    int find(Page page) const { return where.find(page); }
+    void unlink(int n) {
+        Node &x = nodes[n];
+        (x.prev >= 0 ? nodes[x.prev].next : head[x.list]) = x.next;
+        (x.next >= 0 ? nodes[x.next].prev : tail[x.list]) = x.prev;
+        size[x.list]--;
+    }
+    void pushFront(int n, int list) {
+        Node &x = nodes[n];
+        x.list = list;
+        x.prev = -1;
+        x.next = head[list];
+        (head[list] >= 0 ? nodes[head[list]].prev : tail[list]) = n;
+        head[list] = n;
+        size[list]++;
+    }
+    void moveFront(int n, int list) {
+        unlink(n);
+        pushFront(n, list);
+    }
+    int add(Page page, int list) {
+        int n = freeNodes.back();
+        freeNodes.pop_back();
+        nodes[n].page = page;
+        nodes[n].ref = false;
+        where.insert(page, n);
+        pushFront(n, list);
+        return n;
+    }
+    void drop(int n) {
+        unlink(n);
+        where.erase(nodes[n].page);
+        freeNodes.push_back(n);
+    }
+    vector<Page> pages(initializer_list<int> lists) const {
+        vector<Page> out;
+        for (int l : lists)
+            for (int n = head[l]; n >= 0; n = nodes[n].next) out.push_back(nodes[n].page);
+        return out;
+    }
+};
+
+// 2Q (Johnson & Shasha, full version): new pages enter the FIFO A1in; pages
+// pushed out of A1in are remembered in the ghost FIFO A1out, and only a page
+// re-referenced while in A1out is promoted to the LRU list Am. Scanned pages
+// pass through A1in without disturbing Am.
+struct TwoQFrames {
+    enum { AM, A1IN, A1OUT };
+    PageLists l;
+    int capacity, kin, kout;
+
+    explicit TwoQFrames(int capacity, double inShare = 0.25, double outShare = 0.5)
+        : l(capacity + max(1, int(capacity * outShare)) + 1), capacity(capacity),
+          kin(max(1, int(capacity * inShare))), kout(max(1, int(capacity * outShare))) {}
+
+    void reclaim() {
+        if (l.size[AM] + l.size[A1IN] < capacity) return;
+        if (l.size[A1IN] > kin || l.size[AM] == 0) {
+            l.moveFront(l.tail[A1IN], A1OUT);
+            if (l.size[A1OUT] > kout) l.drop(l.tail[A1OUT]);
+        } else {
+            l.drop(l.tail[AM]);
+        }
+    }
+    bool access(Page page) {
+        int n = l.find(page);
+        if (n >= 0 && l.nodes[n].list == AM) {
+            l.moveFront(n, AM);
+            return true;
+        }
+        if (n >= 0 && l.nodes[n].list == A1IN) return true;
+        if (n >= 0) {
+            l.drop(n);
+            reclaim();
+            l.add(page, AM);
+        } else {
+            reclaim();
+            l.add(page, A1IN);
+        }
+        return false;
+    }
+    vector<Page> pages() const { return l.pages({A1IN, AM}); }
+};
+
+// CAR (Bansal & Modha): ARC's adaptation with CLOCKs in place of T1/T2, so a
+// hit only sets a reference bit. Each clock is a list whose back is the hand
+// and whose front is the insertion point.
+struct CarFrames {
+    enum { T1, T2, B1, B2 };
+    PageLists l;
+    int capacity, p = 0;
+
+    explicit CarFrames(int capacity) : l(2 * capacity + 1), capacity(capacity) {}
+
+    void replace() {
+        while (true) {
+            if (l.size[T1] >= max(1, p)) {
+                int n = l.tail[T1];
+                if (!l.nodes[n].ref) {
+                    l.moveFront(n, B1);
+                    return;
+                }
+                l.nodes[n].ref = false;
+                l.moveFront(n, T2);
+            } else {
+                int n = l.tail[T2];
+                if (!l.nodes[n].ref) {
+                    l.moveFront(n, B2);
+                    return;
+                }
+                l.nodes[n].ref = false;
+                l.moveFront(n, T2);
+            }
+        }
+    }
+    bool access(Page page) {
+        int n = l.find(page);
+        if (n >= 0 && (l.nodes[n].list == T1 || l.nodes[n].list == T2)) {
+            l.nodes[n].ref = true;
+            return true;
+        }
+        bool ghost = n >= 0;
+        if (l.size[T1] + l.size[T2] == capacity) {
+            replace();
+            if (!ghost && l.size[T1] + l.size[B1] == capacity)
+                l.drop(l.tail[B1]);
+            else if (!ghost && l.size[T1] + l.size[T2] + l.size[B1] + l.size[B2] == 2 * capacity)
+                l.drop(l.tail[B2]);
+        }
+        if (!ghost) {
+            l.add(page, T1);
+        } else {
+            int b1 = l.size[B1], b2 = l.size[B2];
+            if (l.nodes[n].list == B1) p = min(capacity, p + max(1, b2 / b1));
+            else p = max(0, p - max(1, b1 / b2));
+            l.moveFront(n, T2);
+            l.nodes[n].ref = false;
+        }
+        return false;
+    }
+    vector<Page> pages() const { return l.pages({T1, T2}); }
+};
+
+// ARC Page Replacement
+template <class Range, class Sink = CountSink>
+long long arc(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    ArcFrames frames(capacity);
+    return simulate("ARC", frames, pages, sink);
+}
+
+// 2Q Page Replacement
+template <class Range, class Sink = CountSink>
+long long twoQ(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    TwoQFrames frames(capacity);
+    return simulate("2Q", frames, pages, sink);
+}
+
+// CAR Page Replacement
+template <class Range, class Sink = CountSink>
+long long car(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    CarFrames frames(capacity);
+    return simulate("CAR", frames, pages, sink);
+}
+
+// LIRS (Jiang & Zhang): ranks pages by reuse distance rather than recency.
+// Stack S holds recently referenced pages, including non-resident "ghost"
+// HIR pages, and its bottom is always a LIR page. Q holds the resident HIR
+// pages, which are the only eviction candidates. Ghosts are kept on a third
+// FIFO list N and the oldest is dropped once there are more than ghostMax,
+// which bounds memory on traces with many distinct pages.
+struct LirsFrames {
+    enum State : uint8_t { LIR, HIR, GHOST };
+    enum { S, Q, N };
+    struct Node { Page page; int prev[3], next[3]; bool in[3]; State state; };
+    vector<Node> nodes;
+    vector<int> freeNodes;
+    int head[3] = {-1, -1, -1}, tail[3] = {-1, -1, -1}, size[3] = {0, 0, 0};
+    int capacity, lirMax, ghostMax, lirCount = 0, resident = 0;
+    PageIndex where;
+
+    explicit LirsFrames(int capacity, double ghostRatio = 2.0)
+        : nodes(capacity + int(capacity * ghostRatio) + 2), capacity(capacity),
+          lirMax(max(1, capacity - max(1, capacity / 100))), ghostMax(capacity * ghostRatio),
+          where(nodes.size()) {
+        for (int i = nodes.size() - 1; i >= 0; i--) freeNodes.push_back(i);
+    }
+
+    void unlink(int n, int list) {
+        Node &x = nodes[n];
+        (x.prev[list] >= 0 ? nodes[x.prev[list]].next[list] : head[list]) = x.next[list];
+        (x.next[list] >= 0 ? nodes[x.next[list]].prev[list] : tail[list]) = x.prev[list];
+        x.in[list] = false;
+        size[list]--;
+    }
+    void pushFront(int n, int list) {
+        Node &x = nodes[n];
+        x.prev[list] = -1;
+        x.next[list] = head[list];
+        (head[list] >= 0 ? nodes[head[list]].prev[list] : tail[list]) = n;
+        head[list] = n;
+        x.in[list] = true;
+        size[list]++;
+    }
+    void toTop(int n, int list) {
+        if (nodes[n].in[list]) unlink(n, list);
+        pushFront(n, list);
+    }
+    void release(int n) {
+        for (int list = 0; list < 3; list++)
+            if (nodes[n].in[list]) unlink(n, list);
+        where.erase(nodes[n].page);
+        freeNodes.push_back(n);
+    }
+    // Drop HIR and ghost entries from the bottom of S until a LIR page is there
+    void prune() {
+        while (tail[S] >= 0 && nodes[tail[S]].state != LIR) {
+            int n = tail[S];
+            if (nodes[n].state == GHOST) release(n);
+            else unlink(n, S);
+        }
+    }
+    // The bottom LIR page loses its status to make room for a new LIR page
+    void demoteBottom() {
+        prune();
+        int b = tail[S];
+        unlink(b, S);
+        nodes[b].state = HIR;
+        pushFront(b, Q);
+        lirCount--;
+        prune();
+    }
+    bool access(Page page) {
+        int n = where.find(page);
+        if (n >= 0 && nodes[n].state == LIR) {
+            toTop(n, S);
+            prune();
+            return true;
+        }
+        if (n >= 0 && nodes[n].state == HIR) {
+            if (nodes[n].in[S]) {
+                // Reused within the LIR set's recency: promote
+                toTop(n, S);
+                unlink(n, Q);
+                nodes[n].state = LIR;
+                lirCount++;
+                demoteBottom();
+            } else {
+                toTop(n, S);
+                toTop(n, Q);
+            }
+            return true;
+        }
+
+        if (resident == capacity) {
+            // Evict the oldest resident HIR page; it stays in S as a ghost.
+            // With a single frame there may be no HIR page, so take the LIR one.
+            int v = tail[Q];
+            if (v >= 0) {
+                unlink(v, Q);
+                if (nodes[v].in[S]) {
+                    nodes[v].state = GHOST;
+                    pushFront(v, N);
+                } else {
+                    release(v);
+                }
+            } else {
+                v = tail[S];
+                lirCount--;
+                release(v);
+                prune();
+            }
+            resident--;
+        }
+        bool ghost = n >= 0;
+        if (ghost) {
+            unlink(n, N);
+        } else {
+            n = freeNodes.back();
+            freeNodes.pop_back();
+            nodes[n].page = page;
+            nodes[n].in[S] = nodes[n].in[Q] = nodes[n].in[N] = false;
+            where.insert(page, n);
+        }
+        resident++;
+        if (lirCount < lirMax || ghost) {
+            toTop(n, S);
+            nodes[n].state = LIR;
+            if (++lirCount > lirMax) demoteBottom();
+        } else {
+            nodes[n].state = HIR;
+            pushFront(n, S);
+            pushFront(n, Q);
+        }
+        while (size[N] > ghostMax) release(tail[N]);
+        return false;
+    }
+    vector<Page> pages() const {
+        vector<Page> out;
+        for (int n = head[S]; n >= 0; n = nodes[n].next[S])
+            if (nodes[n].state == LIR) out.push_back(nodes[n].page);
+        for (int n = head[Q]; n >= 0; n = nodes[n].next[Q]) out.push_back(nodes[n].page);
+        return out;
+    }
+};
+
+// Approximate access counts for TinyLFU: a count-min sketch of depth 4 with
+// 4-bit saturating counters packed 16 to a word, in front of a doorkeeper
+// bloom filter that absorbs the first reference of each page (most pages in
+// a long trace are one-hit wonders). Every `sampleSize` references all
+// counters are halved and the doorkeeper is cleared, so old popularity
+// decays. It is sized from the cache capacity, not the number of distinct
+// pages: about 4 bytes of counters and 1 byte of doorkeeper per frame.
+struct FrequencySketch {
+    vector<uint64_t> table, doorkeeper;
+    uint64_t counterMask, doorMask;
+    long long additions = 0, sampleSize;
+
+    explicit FrequencySketch(int capacity) {
+        uint64_t n = 16;
+        while (n < (uint64_t)capacity) n <<= 1;
+        table.assign(n / 2, 0);                 // 8 counters per frame
+        doorkeeper.assign(n / 8, 0);            // 8 bits per frame
+        counterMask = n * 8 - 1;
+        doorMask = n * 8 - 1;
+        sampleSize = 10LL * max(capacity, 1);
+    }
+    static uint64_t mix(uint64_t x) {
+        x ^= x >> 30, x *= 0xBF58476D1CE4E5B9ULL;
+        x ^= x >> 27, x *= 0x94D049BB133111EBULL;
+        return x ^ (x >> 31);
+    }
+    // i-th probe by double hashing
+    static uint64_t probe(uint64_t h, int i) { return h + i * ((h >> 32) | 1); }
+
+    int counter(uint64_t i) const { return (table[i >> 4] >> ((i & 15) * 4)) & 15; }
+    bool inDoorkeeper(uint64_t h) const {
+        for (int i = 0; i < 3; i++) {
+            uint64_t b = probe(~h, i) & doorMask;
+            if (!(doorkeeper[b >> 6] >> (b & 63) & 1)) return false;
+        }
+        return true;
+    }
+    int frequency(Page page) const {
+        uint64_t h = mix(page);
+        int f = 15;
+        for (int i = 0; i < 4; i++) f = min(f, counter(probe(h, i) & counterMask));
+        return f + inDoorkeeper(h);
+    }
+    void increment(Page page) {
+        uint64_t h = mix(page);
+        if (!inDoorkeeper(h)) {
+            for (int i = 0; i < 3; i++) {
+                uint64_t b = probe(~h, i) & doorMask;
+                doorkeeper[b >> 6] |= 1ULL << (b & 63);
+            }
+        } else {
+            for (int i = 0; i < 4; i++) {
+                uint64_t c = probe(h, i) & counterMask;
+                if (counter(c) < 15) table[c >> 4] += 1ULL << ((c & 15) * 4);
+            }
+        }
+        if (++additions == sampleSize) age();
+    }
+    void age() {
+        for (auto &w : table) w = (w >> 1) & 0x7777777777777777ULL;
+        fill(doorkeeper.begin(), doorkeeper.end(), 0);
+        additions = 0;
+    }
+};
+
+// W-TinyLFU (Einziger, Friedman & Manes): a small LRU window (1%) in front of
+// a segmented LRU main area (20% probation, 80% protected). A page leaving
+// the window only enters the main area if the sketch says it is referenced
+// more often than the probation victim it would displace.
+struct TinyLfuFrames {
+    enum { WINDOW, PROBATION, PROTECTED };
+    PageLists l;
+    FrequencySketch sketch;
+    int windowMax, mainMax, protectedMax;
+
+    explicit TinyLfuFrames(int capacity)
+        : l(capacity + 1), sketch(capacity), windowMax(max(1, capacity / 100)),
+          mainMax(capacity - windowMax), protectedMax(mainMax * 4 / 5) {}
+
+    bool access(Page page) {
+        sketch.increment(page);
+        int n = l.find(page);
+        if (n >= 0) {
+            if (l.nodes[n].list == PROBATION) {
+                l.moveFront(n, PROTECTED);
+                if (l.size[PROTECTED] > protectedMax) l.moveFront(l.tail[PROTECTED], PROBATION);
+            } else {
+                l.moveFront(n, l.nodes[n].list);
+            }
+            return true;
+        }
+        l.add(page, WINDOW);
+        if (l.size[WINDOW] > windowMax) {
+            int candidate = l.tail[WINDOW];
+            if (l.size[PROBATION] + l.size[PROTECTED] < mainMax) {
+                l.moveFront(candidate, PROBATION);
+            } else {
+                int victim = l.tail[PROBATION] >= 0 ? l.tail[PROBATION] : l.tail[PROTECTED];
+                if (victim >= 0 && sketch.frequency(l.nodes[candidate].page) > sketch.frequency(l.nodes[victim].page)) {
+                    l.drop(victim);
+                    l.moveFront(candidate, PROBATION);
+                } else {
+                    l.drop(candidate);
+                }
+            }
+        }
+        return false;
+    }
+    vector<Page> pages() const { return l.pages({WINDOW, PROBATION, PROTECTED}); }
+};
+
+// LIRS Page Replacement
+template <class Range, class Sink = CountSink>
+long long lirs(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    LirsFrames frames(capacity);
+    return simulate("LIRS", frames, pages, sink);
+}
+
+// W-TinyLFU Page Replacement
+template <class Range, class Sink = CountSink>
+long long tinyLfu(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    TinyLfuFrames frames(capacity);
+    return simulate("W-TinyLFU", frames, pages, sink);
+}
+
+// Next-use table: next[i] = index of the next reference to pages[i], or
+// pages.size() if it is never referenced again. Built in one forward pass
+// (each reference fills in its predecessor's slot) so a streamed trace works
+// as well as a vector; only the table itself is kept in memory.
+template <class Range>
+vector<long long> nextUses(const Range &pages) {
+    vector<long long> next;
+    next.reserve(pages.size());
+    unordered_map<Page, long long> last;
+    last.reserve(1024);
+    for (auto x : pages) {
+        Page p = asRef(x).page;
+        long long i = next.size();
+        auto [it, fresh] = last.try_emplace(p, i);
+        if (!fresh) next[it->second] = i, it->second = i;
+        next.push_back(-1);
+    }
+    for (auto &x : next)
+        if (x < 0) x = next.size();
+    return next;
+}
+
+// OPT engine over a precomputed next-use table, which several engines (one
+// per capacity) can share read-only. Resident frames sit in an ordered set
+// keyed by (next use, -slot): the largest key is the victim, ties among
+// never-used-again pages go to the lowest slot, so the choice matches a
+// left-to-right scan of the frames. O(log C) per reference.
+struct OptimalFrames {
+    const vector<long long> &next;
+    vector<Page> frames;
+    vector<long long> slotNext;
+    int capacity, slot = -1;
+    long long i = -1;
+    PageIndex where;
+    set<pair<long long, int>> byNext;
+
+    OptimalFrames(const vector<long long> &next, int capacity)
+        : next(next), slotNext(capacity), capacity(capacity), where(capacity) {}
+
+    bool access(Page p) {
+        i++;
+        int f = where.find(p);
+        if (f >= 0) {
+            byNext.erase({slotNext[f], -f});
+            slotNext[f] = next[i];
+            byNext.insert({next[i], -f});
+            slot = f;
+            return true;
+        }
+        if ((int)frames.size() < capacity) {
+            f = frames.size();
+            frames.push_back(p);
+        } else {
+            auto victim = prev(byNext.end());
+            // Only possible with one frame whose page is needed next: keep it
+            if (victim->first <= i + 1 && victim->first < (long long)next.size()) {
+                slot = -1;
+                return false;
+            }
+            f = -victim->second;
+            byNext.erase(victim);
+            where.erase(frames[f]);
+            frames[f] = p;
+        }
+        where.insert(p, f);
+        slotNext[f] = next[i];
+        byNext.insert({next[i], -f});
+        slot = f;
+        return false;
+    }
+    vector<Page> pages() const { return frames; }
+};
+
+// Optimal Page Replacement
+template <class Range, class Sink = CountSink>
+long long optimal(const Range &pages, int capacity, Sink &&sink = Sink()) {
+    vector<long long> next = nextUses(pages);
+    OptimalFrames frames(next, capacity);
+    return simulate("Optimal", frames, pages, sink);
+}
+
+// The frame-vector scans lru() and optimal() ran before their engines, kept
+// as references. The engines must reproduce their faults and their frames
+// slot for slot, including the old optimal() keeping a lone frame whose page
+// is needed next instead of loading the faulting page.
+long long lruScan(const vector<int> &pages, int capacity, vector<Page> &frames) {
+    unordered_map<Page, long long> lastUsed;
+    long long faults = 0, time = 0;
+    frames.clear();
+    for (Page p : pages) {
+        time++;
+        if (find(frames.begin(), frames.end(), p) == frames.end()) {
+            if ((int)frames.size() < capacity) {
+                frames.push_back(p);
+            } else {
+                auto victim = min_element(frames.begin(), frames.end(),
+                                          [&](Page a, Page b) { return lastUsed[a] < lastUsed[b]; });
+                *victim = p;
+            }
+            faults++;
+        }
+        lastUsed[p] = time;
+    }
+    return faults;
+}
+
+long long optimalScan(const vector<int> &pages, int capacity, vector<Page> &frames) {
+    long long faults = 0, n = pages.size();
+    frames.clear();
+    for (long long i = 0; i < n; i++) {
+        Page p = pages[i];
+        if (find(frames.begin(), frames.end(), p) != frames.end()) continue;
+        faults++;
+        if ((int)frames.size() < capacity) {
+            frames.push_back(p);
+            continue;
+        }
+        long long victim = -1, farthest = i + 1;
+        for (size_t f = 0; f < frames.size(); f++) {
+            long long j = i + 1;
+            while (j < n && pages[j] != frames[f]) j++;
+            if (j == n) {
+                victim = f;
+                break;
+            }
+            if (j > farthest) {
+                farthest = j;
+                victim = f;
+            }
+        }
+        if (victim >= 0) frames[victim] = p;
+    }
+    return faults;
+}
+
+// Fault counts and final frames of LruFrames / OptimalFrames against the
+// scans above at each capacity; prints and returns whether all match
+bool engineParity(const vector<int> &pages, const vector<int> &capacities) {
+    cout << "\n=== LRU / Optimal engines vs reference scans (" << pages.size() << " references) ===\n";
+    vector<long long> next = nextUses(pages);
+    bool same = true;
+    for (int c : capacities) {
+        vector<Page> lruRef, optRef;
+        long long lruFaults = lruScan(pages, c, lruRef), optFaults = optimalScan(pages, c, optRef);
+        LruFrames lruEngine(c);
+        OptimalFrames optEngine(next, c);
+        bool ok = countFaults(lruEngine, pages) == lruFaults && lruEngine.pages() == lruRef &&
+                  countFaults(optEngine, pages) == optFaults && optEngine.pages() == optRef;
+        cout << "Frames " << c << ": LRU " << lruFaults << ", Optimal " << optFaults << " faults"
+             << (ok ? "" : "  MISMATCH") << "\n";
+        same = same && ok;
+    }
+    cout << "Engines identical to the reference scans: " << (same ? "yes" : "NO") << "\n";
+    return same;
+}
+
+// Fenwick (binary indexed) tree: point update, prefix sum, both O(log N).
+// 64-bit positions and sums: lruFaultCurve indexes it by reference number,
+// and streamed traces can run past 2^31 references.
+struct Fenwick {
+    vector<long long> tree;
+    explicit Fenwick(long long n) : tree(n + 1, 0) {}
+    void add(long long i, long long delta) {
+        for (; i < (long long)tree.size(); i += i & -i) tree[i] += delta;
+    }
+    long long sum(long long i) const {   // sum of [1, i]
+        long long s = 0;
+        for (; i > 0; i -= i & -i) s += tree[i];
+        return s;
+    }
+};
+
+// LRU faults for every capacity 1..maxCapacity in one pass (Mattson).
+// A page's stack distance is the number of distinct pages touched since its
+// previous reference, plus one; LRU with C frames hits exactly when the
+// distance is <= C. Each page's latest reference time is marked in a Fenwick
+// tree, so a distance is one range count: O(N log N) for the whole curve.
+// maxCapacity = 0 means up to the number of distinct pages.
+template <class Range>
+vector<long long> lruFaultCurve(const Range &pages, int maxCapacity = 0) {
+    long long n = pages.size(), t = 0;
+    Fenwick marks(n);
+    unordered_map<Page, long long> last;  // page -> time of previous reference (1-based)
+    last.reserve(1024);
+    vector<long long> hist(n + 2, 0); // hist[d] = references at stack distance d
+    long long cold = 0;
+
+    for (Page p : pages) {
+        t++;
+        auto it = last.find(p);
+        if (it == last.end()) {
+            cold++;
+            last.emplace(p, t);
+        } else {
+            long long s = it->second;
+            hist[marks.sum(t - 1) - marks.sum(s) + 1]++;
+            marks.add(s, -1);
+            it->second = t;
+        }
+        marks.add(t, 1);
+    }
+
+    if (maxCapacity <= 0) maxCapacity = last.size();
+    // faults[c] = cold misses + references with distance > c
+    vector<long long> faults(maxCapacity + 1);
+    long long beyond = 0;
+    for (long long d = n + 1; d > maxCapacity; d--) beyond += hist[d];
+    for (int c = maxCapacity; c >= 1; c--) {
+        faults[c] = cold + beyond;
+        if (c <= n + 1) beyond += hist[c];  // no distance exceeds n + 1: only cold misses above
+    }
+    faults[0] = n;
+    return faults;
+}
+
+// Miss-ratio curve for one trace
+template <class Range>
+void mrc(const Range &pages, int maxCapacity = 0) {
+    cout << "\n=== LRU Miss-Ratio Curve (single pass) ===\n";
+    vector<long long> faults = lruFaultCurve(pages, maxCapacity);
+    cout << "Frames\tFaults\tMiss ratio\n";
+    for (size_t c = 1; c < faults.size(); c++)
+        cout << c << "\t" << faults[c] << "\t" << (double)faults[c] / pages.size() << "\n";
+}
+
+// Trace characterization in one streaming pass, for choosing a policy before
+// simulating any. Per reference it records
+//   reuse distance:  LRU stack distance as in lruFaultCurve (1 = re-reference
+//                    of the most recent page), so bucket edges read as frames
+//   inter-reference gap: references since the page's previous reference
+// plus footprint (distinct pages so far) at evenly spaced points and the
+// pages referenced only once (one-hit wonders). Histograms are log2-bucketed:
+// bucket i counts values in [2^i, 2^(i+1)); first references go to `cold`.
+// lruFaultCurve keeps a Fenwick slot per reference; here the slots of the
+// latest references are renumbered 1..distinct whenever the tree fills, so
+// memory stays O(distinct pages) however long the trace.
+struct TraceProfile {
+    long long refs = 0, distinct = 0, oneHitPages = 0;
+    vector<long long> reuseDistance, gap;     // log2 buckets
+    vector<long long> footprintAt, footprint; // reference count -> distinct pages
+};
+
+inline int log2Bucket(long long v) { return 63 - __builtin_clzll(v); }
+
+template <class Range>
+TraceProfile profileTrace(const Range &pages, int points = 32) {
+    struct Seen {
+        long long time;   // 1-based reference number of the latest reference
+        int slot;         // its Fenwick slot
+        bool reused;
+    };
+    TraceProfile prof;
+    prof.reuseDistance.assign(64, 0);
+    prof.gap.assign(64, 0);
+    long long n = pages.size(), t = 0;
+    points = (int)min<long long>(max(points, 1), max(n, 1LL));
+    long long nextPoint = (n + points - 1) / points;
+    int k = 1;
+
+    unordered_map<Page, Seen> last;
+    last.reserve(1024);
+    int slots = 1024, next = 1;       // next free Fenwick slot
+    Fenwick marks(slots);
+    vector<Seen *> bySlot;
+    for (Page p : pages) {
+        t++;
+        if (next > slots) {
+            // Renumber the live slots in order; leave as many free again
+            bySlot.assign(slots + 1, nullptr);
+            for (auto &e : last) bySlot[e.second.slot] = &e.second;
+            slots = max<int>(1024, 2 * last.size());
+            marks = Fenwick(slots);
+            next = 1;
+            for (Seen *s : bySlot)
+                if (s) marks.add(s->slot = next++, 1);
+        }
+        auto [it, cold] = last.try_emplace(p, Seen{t, next, false});
+        if (!cold) {
+            Seen &s = it->second;
+            // marked slots after s.slot = distinct pages referenced since
+            prof.reuseDistance[log2Bucket(last.size() - marks.sum(s.slot) + 1)]++;
+            prof.gap[log2Bucket(t - s.time)]++;
+            if (!s.reused) prof.oneHitPages--;
+            marks.add(s.slot, -1);
+            s = {t, next, true};
+        } else {
+            prof.oneHitPages++;
+        }
+        marks.add(next++, 1);
+        if (t == nextPoint) {
+            prof.footprintAt.push_back(t);
+            prof.footprint.push_back(last.size());
+            nextPoint = (n * ++k + points - 1) / points;
+        }
+    }
+    prof.refs = t;
+    prof.distinct = last.size();
+    for (auto *h : {&prof.reuseDistance, &prof.gap})
+        while (!h->empty() && !h->back()) h->pop_back();
+    return prof;
+}
+
+// The profile as one line of JSON
+void printProfile(const TraceProfile &p) {
+    auto list = [](const vector<long long> &v) {
+        string s = "[";
+        for (size_t i = 0; i < v.size(); i++) s += (i ? ", " : "") + to_string(v[i]);
+        return s + "]";
+    };
+    double refs = max(p.refs, 1LL);
+    cout << setprecision(6) << "{\"references\": " << p.refs << ", \"distinct_pages\": " << p.distinct
+         << ", \"one_hit_wonders\": {\"pages\": " << p.oneHitPages
+         << ", \"page_share\": " << (double)p.oneHitPages / max(p.distinct, 1LL)
+         << ", \"reference_share\": " << p.oneHitPages / refs << "}"
+         << ", \"reuse_distance\": {\"buckets\": \"log2\", \"cold\": " << p.distinct
+         << ", \"counts\": " << list(p.reuseDistance) << "}"
+         << ", \"inter_reference_gap\": {\"buckets\": \"log2\", \"cold\": " << p.distinct
+         << ", \"counts\": " << list(p.gap) << "}"
+         << ", \"footprint\": {\"references\": " << list(p.footprintAt)
+         << ", \"pages\": " << list(p.footprint) << "}}\n";
+}
+
+// SHARDS: sampled LRU miss-ratio curve in bounded memory
+// A reference is sampled when hash(page) mod P < T, so every reference to a
+// sampled page is kept (spatial sampling, rate R = T / P). Stack distances are
+// computed among sampled pages only and scaled by 1 / R. Latest reference times
+// live in an order-statistics tree whose size is the number of sampled pages.
+//   fixed rate:  T never changes; memory ~ R x distinct pages
+//   fixed size:  at most maxTracked pages; when full, the page with the
+//                largest hash is dropped and T lowers to that hash
+// Each sampled reference is weighted by 1 / R at the time it is seen, and the
+// total is corrected to the trace length at the end (SHARDS_adj).
+// The error estimate comes from running the same sampler under several
+// independent hash seeds in the same pass: the curve is seed 0's, and the
+// spread of the seeds' curves says how much another sample could differ.
+using OrderedTimes = __gnu_pbds::tree<long long, __gnu_pbds::null_type, less<long long>,
+                                      __gnu_pbds::rb_tree_tag,
+                                      __gnu_pbds::tree_order_statistics_node_update>;
+
+struct ShardsCurve {
+    vector<double> missRatio;   // index = frames, 1..maxCapacity
+    double rate;                // final sampling rate
+    long long sampledRefs = 0;
+    long long sampledPages = 0; // distinct pages seen in the sample
+    int seeds = 1;
+    double errorBound = 0;      // estimate: 2 x the largest std dev across seeds
+};
+
+// splitmix64 finalizer over all 64 bits of the page, so pages of a 64-bit
+// address space that differ only in their high bits are sampled independently.
+// Each seed starts the mix from a different odd multiple of the golden ratio.
+uint32_t shardsHash(Page page, uint64_t seed = 0) {
+    uint64_t x = (uint64_t)page + 0x9E3779B97F4A7C15ULL * (2 * seed + 1);
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBULL;
+    x ^= x >> 31;
+    return x >> 40;             // top 24 bits: P = 2^24
+}
+
+// One sampler: a hash seed and the state of its sampled pages
+struct ShardsSampler {
+    static constexpr double P = 1 << 24;
+    uint64_t seed;
+    int maxCapacity, maxTracked;
+    uint32_t threshold;
+    OrderedTimes times;
+    unordered_map<Page, long long> last;  // sampled page -> latest sampled time
+    set<pair<uint32_t, Page>> byHash;     // fixed size: eviction order
+    vector<double> hist;
+    double weight = 0, cold = 0;
+    long long t = 0, sampledRefs = 0, sampledPages = 0;
+
+    ShardsSampler(uint64_t seed, int maxCapacity, double rate, int maxTracked)
+        : seed(seed), maxCapacity(maxCapacity), maxTracked(maxTracked),
+          threshold((uint32_t)min(P, max(1.0, rate * P))), hist(maxCapacity + 2, 0) {}
+
+    void visit(Page p) {
+        uint32_t h = shardsHash(p, seed);
+        if (h >= threshold) return;
+        double R = threshold / P, w = 1 / R;
+        t++;
+        sampledRefs++;
+        weight += w;
+        auto it = last.find(p);
+        if (it == last.end()) {
+            cold += w;
+            sampledPages++;
+            last.emplace(p, t);
+            if (maxTracked > 0) byHash.insert({h, p});
+        } else {
+            // Sampled pages touched since p's previous reference, scaled up; p itself adds 1
+            long long between = times.size() - times.order_of_key(it->second) - 1;
+            long long d = llround(between / R) + 1;
+            hist[min<long long>(d, maxCapacity + 1)] += w;
+            times.erase(it->second);
+            it->second = t;
+        }
+        times.insert(t);
+
+        while (maxTracked > 0 && (int)last.size() > maxTracked) {
+            auto top = prev(byHash.end());
+            threshold = top->first;
+            // Drop every tracked page at or above the new threshold
+            while (!byHash.empty() && prev(byHash.end())->first >= threshold) {
+                auto victim = prev(byHash.end());
+                times.erase(last[victim->second]);
+                last.erase(victim->second);
+                byHash.erase(victim);
+            }
+        }
+    }
+
+    vector<double> missRatio(long long refs) {
+        // SHARDS_adj: a popular page landing in (or missing from) the sample skews
+        // the total. The sampled weight should equal the trace length, so the
+        // difference is booked as hits at distance 1, where it distorts least.
+        hist[1] += (double)refs - weight;
+        double total = refs;
+        vector<double> m(maxCapacity + 1, 1.0);
+        double beyond = hist[maxCapacity + 1];
+        for (int cap = maxCapacity; cap >= 1; cap--) {
+            m[cap] = total > 0 ? min(1.0, (cold + beyond) / total) : 1.0;
+            beyond += hist[cap];
+        }
+        return m;
+    }
+};
+
+template <class Range>
+ShardsCurve shardsMissRatio(const Range &pages, int maxCapacity, double rate,
+                            int maxTracked = 0, int seeds = 4) {
+    vector<ShardsSampler> samplers;
+    for (int s = 0; s < max(seeds, 1); s++) samplers.emplace_back(s, maxCapacity, rate, maxTracked);
+    for (Page p : pages)
+        for (auto &s : samplers) s.visit(p);
+
+    ShardsCurve c;
+    vector<vector<double>> curves;
+    for (auto &s : samplers) curves.push_back(s.missRatio(pages.size()));
+    c.missRatio = curves[0];
+    c.rate = samplers[0].threshold / ShardsSampler::P;
+    c.sampledRefs = samplers[0].sampledRefs;
+    c.sampledPages = samplers[0].sampledPages;
+    c.seeds = curves.size();
+    for (int cap = 1; cap <= maxCapacity && c.seeds > 1; cap++) {
+        double mean = 0, var = 0;
+        for (auto &m : curves) mean += m[cap] / c.seeds;
+        for (auto &m : curves) var += (m[cap] - mean) * (m[cap] - mean) / (c.seeds - 1);
+        c.errorBound = max(c.errorBound, 2 * sqrt(var));
+    }
+    return c;
+}
+
+// Zipf(s) trace over `distinct` pages, fixed seed
+vector<int> zipfTrace(int n, int distinct, double s, unsigned seed) {
+    vector<double> cdf(distinct);
+    double sum = 0;
+    for (int k = 0; k < distinct; k++) cdf[k] = sum += 1 / pow(k + 1, s);
+    mt19937 rng(seed);
+    uniform_real_distribution<double> u(0, sum);
+    vector<int> trace(n);
+    for (auto &p : trace) p = lower_bound(cdf.begin(), cdf.end(), u(rng)) - cdf.begin();
+    return trace;
+}
+
+// Cross-check SHARDS against the exact single-pass curve: the estimated error
+// from the seeds' spread next to the measured one
+template <class Range>
+void shardsCheck(const Range &pages, int maxCapacity) {
+    cout << "\n=== SHARDS vs exact LRU miss-ratio curve (" << pages.size() << " references, "
+         << maxCapacity << " frames max) ===\n";
+    vector<long long> exact = lruFaultCurve(pages, maxCapacity);
+    auto report = [&](const string &name, const ShardsCurve &c) {
+        double mae = 0, worst = 0;
+        for (int cap = 1; cap <= maxCapacity; cap++) {
+            double err = fabs(c.missRatio[cap] - (double)exact[cap] / pages.size());
+            mae += err / maxCapacity;
+            worst = max(worst, err);
+        }
+        cout << name << ": rate " << c.rate << ", " << c.sampledPages << " pages sampled, "
+             << "estimated error +/-" << c.errorBound << " (" << c.seeds << " seeds), actual MAE " << mae
+             << ", max error " << worst << "\n";
+    };
+    report("Fixed rate 1%   ", shardsMissRatio(pages, maxCapacity, 0.01));
+    report("Fixed size 8192 ", shardsMissRatio(pages, maxCapacity, 0.1, 8192));
+}
+
+// Sampled miss-ratio curve for one trace, for traces too long for mrc()'s
+// exact pass: memory grows with the sample, not the trace. rate is the
+// sampling rate, or the starting one when maxTracked caps the sample.
+template <class Range>
+void shardsMrc(const Range &pages, int maxCapacity, double rate, int maxTracked) {
+    ShardsCurve c = shardsMissRatio(pages, maxCapacity, rate, maxTracked);
+    cout << "\n=== SHARDS LRU Miss-Ratio Curve (rate " << c.rate << ", " << c.sampledPages
+         << " pages sampled) ===\n";
+    cout << "Estimated error +/-" << c.errorBound << " (spread over " << c.seeds << " hash seeds)\n";
+    cout << "Frames\tMiss ratio\n";
+    for (int cap = 1; cap <= maxCapacity; cap++) cout << cap << "\t" << c.missRatio[cap] << "\n";
+}
+
+// Working set WS(tau) (Denning): the resident set is exactly the distinct
+// pages of the last tau references, so the allocation grows and shrinks
+// with the program's locality. A reference faults if its page was not used
+// in the previous tau references. The window is a ring of the last tau
+// pages; the PageIndex maps each page in the window to the ring slot of its
+// latest use, so when a slot is overwritten its page leaves the set only if
+// that slot was its latest use. O(1) per reference, memory O(tau).
+struct WorkingSetFrames {
+    int tau, resident = 0;
+    vector<Page> ring;
+    long long t = 0;
+    PageIndex where;
+
+    explicit WorkingSetFrames(int tau) : tau(tau), ring(tau), where(tau + 1) {}
+
+    bool access(Page page) {
+        int s = t % tau;
+        bool hit = where.find(page) >= 0;
+        if (t >= tau && ring[s] != page && where.find(ring[s]) == s) {
+            where.erase(ring[s]);                  // reference t - tau leaves the window
+            resident--;
+        }
+        if (!hit) resident++;
+        where.insert(page, s);
+        ring[s] = page;
+        t++;
+        return hit;
+    }
+    int size() const { return resident; }
+};
+
+// Page-fault frequency (Chu & Opderbeck): on a fault, if more than
+// `threshold` references have passed since the previous fault the process
+// has more memory than it needs, and every page not referenced since that
+// fault is released (the page that fault loaded counts as referenced at it,
+// so it stays); otherwise the allocation just grows by one. Pages sit
+// on an LRU-ordered list with their last-use time, so the released pages
+// are a suffix of the list and are dropped from the tail. maxFrames caps the
+// allocation (physical memory), evicting LRU when reached.
+struct PffFrames {
+    PageLists l;
+    vector<long long> lastUse;
+    long long t = 0, lastFault = 0;
+    int threshold, maxFrames;
+
+    PffFrames(int threshold, int maxFrames)
+        : l(maxFrames + 1), lastUse(maxFrames + 1), threshold(threshold), maxFrames(maxFrames) {}
+
+    bool access(Page page) {
+        t++;
+        int n = l.find(page);
+        if (n >= 0) {
+            l.moveFront(n, 0);
+            lastUse[n] = t;
+            return true;
+        }
+        if (t - lastFault > threshold)
+            while (l.tail[0] >= 0 && lastUse[l.tail[0]] < lastFault) l.drop(l.tail[0]);
+        lastFault = t;
+        if (l.size[0] == maxFrames) l.drop(l.tail[0]);
+        lastUse[l.add(page, 0)] = t;
+        return false;
+    }
+    int size() const { return l.size[0]; }
+};
+
+struct AllocationStats {
+    long long refs = 0, faults = 0;
+    double meanFrames = 0;
+    int maxFrames = 0;
+    vector<double> framesOverTime;   // mean allocation in each equal slice of the trace
+};
+
+// Runs a variable-allocation engine (access() and size()) and samples its
+// allocation after every reference
+template <class Frames, class Range>
+AllocationStats allocation(Frames &frames, const Range &pages, int slices = 20) {
+    AllocationStats st;
+    long long per = max<long long>(1, (pages.size() + slices - 1) / slices), inSlice = 0;
+    double total = 0, sliceTotal = 0;
+    for (Page p : pages) {
+        st.refs++;
+        st.faults += !frames.access(p);
+        int size = frames.size();
+        total += size;
+        sliceTotal += size;
+        st.maxFrames = max(st.maxFrames, size);
+        if (++inSlice == per) {
+            st.framesOverTime.push_back(sliceTotal / per);
+            sliceTotal = 0, inSlice = 0;
+        }
+    }
+    if (inSlice) st.framesOverTime.push_back(sliceTotal / inSlice);
+    st.meanFrames = st.refs ? total / st.refs : 0;
+    return st;
+}
+
+// WS(tau) and PFF against fixed frames: for each run, the smallest fixed
+// LRU allocation with no more faults (from the single-pass fault curve) and
+// how much memory the variable allocation saves on average
+template <class Range>
+void allocationReport(const Range &pages, const vector<int> &taus, const vector<int> &pffThresholds,
+                      int maxFrames = 0) {
+    vector<long long> lruFaults = lruFaultCurve(pages);
+    int distinct = lruFaults.size() - 1;
+    if (maxFrames <= 0) maxFrames = max(distinct, 1);
+    auto fixedFor = [&](long long faults) {
+        int c = 1;
+        while (c < distinct && lruFaults[c] > faults) c++;
+        return c;
+    };
+
+    cout << "\n=== Variable allocation vs fixed frames (" << pages.size() << " references, "
+         << distinct << " pages) ===\n";
+    cout << left << setw(14) << "Policy" << right << setw(10) << "Faults" << setw(12) << "Fault rate"
+         << setw(13) << "Mean frames" << setw(12) << "Max frames" << setw(12) << "LRU frames"
+         << setw(9) << "Saved" << "\n";
+    vector<pair<string, AllocationStats>> runs;
+    for (int tau : taus) {
+        WorkingSetFrames ws(tau);
+        runs.push_back({"WS(" + to_string(tau) + ")", allocation(ws, pages)});
+    }
+    for (int threshold : pffThresholds) {
+        PffFrames pff(threshold, maxFrames);
+        runs.push_back({"PFF(" + to_string(threshold) + ")", allocation(pff, pages)});
+    }
+    for (auto &[name, st] : runs) {
+        int lruFrames = fixedFor(st.faults);
+        cout << left << setw(14) << name << right << setw(10) << st.faults << fixed << setprecision(4)
+             << setw(12) << (double)st.faults / max(st.refs, 1LL) << setprecision(1) << setw(13)
+             << st.meanFrames << setw(12) << st.maxFrames << setw(12) << lruFrames << setw(8)
+             << 100 * (1 - st.meanFrames / lruFrames) << "%\n";
+        cout.unsetf(ios::fixed);
+    }
+    cout << "Allocation over time (mean frames per twentieth of the trace):\n";
+    for (auto &[name, st] : runs) {
+        cout << left << setw(14) << name << right;
+        for (double f : st.framesOverTime) cout << " " << llround(f);
+        cout << "\n";
+    }
+}
+
+// Synthetic program with phases: each phase loops at random over its own
+// set of pages (50-500), with a few references anywhere in the address space
+vector<int> phaseTrace(int phases, int refsPerPhase, unsigned seed) {
+    mt19937 gen(seed);
+    vector<int> pages;
+    pages.reserve((size_t)phases * refsPerPhase);
+    for (int ph = 0; ph < phases; ph++) {
+        int base = gen() % 100000, size = 50 + gen() % 451;
+        for (int i = 0; i < refsPerPhase; i++)
+            pages.push_back(gen() % 20 == 0 ? gen() % 100000 : base + gen() % size);
+    }
+    return pages;
+}
+
+// k-way merge of per-process traces into one reference stream. The traces
+// carry no clock, so each process is taken to run at a steady rate over the
+// same interval: its i-th of n references happens at time i / n, and a
+// min-heap of the processes' next timestamps gives the global order (ties go
+// to the lower pid). With quantum > 0 a round-robin scheduler runs each live
+// process for `quantum` references in turn instead.
+template <class Trace, class Visit>
+void interleave(const vector<const Trace *> &traces, int quantum, Visit &&visit) {
+    using It = decltype(traces[0]->begin());
+    int k = traces.size();
+    vector<It> it, end;
+    vector<long long> done(k, 0), total(k);
+    for (int p = 0; p < k; p++) {
+        it.push_back(traces[p]->begin());
+        end.push_back(traces[p]->end());
+        total[p] = traces[p]->size();
+    }
+    if (quantum > 0) {
+        for (bool live = true; live;) {
+            live = false;
+            for (int p = 0; p < k; p++)
+                for (int q = 0; q < quantum && it[p] != end[p]; q++, ++it[p]) {
+                    visit(p, (Page)*it[p]);
+                    live = true;
+                }
+        }
+        return;
+    }
+    // done / total compared exactly by cross-multiplying
+    auto later = [&](int a, int b) {
+        __int128 x = (__int128)done[a] * total[b], y = (__int128)done[b] * total[a];
+        return x != y ? x > y : a > b;
+    };
+    priority_queue<int, vector<int>, decltype(later)> heap(later);
+    for (int p = 0; p < k; p++)
+        if (it[p] != end[p]) heap.push(p);
+    while (!heap.empty()) {
+        int p = heap.top();
+        heap.pop();
+        visit(p, (Page)*it[p]);
+        ++it[p];
+        done[p]++;
+        if (it[p] != end[p]) heap.push(p);
+    }
+}
+
+// Global replacement: one frame pool shared by every process, so a process
+// can take frames from the others. The pool is keyed by (pid, page): pages
+// below 2^55 of pids below 256 pack into a non-negative key with the pid in
+// the low 8 bits; anything else gets a negative id from a per-process map,
+// so no two processes' pages ever share a key.
+template <class Frames>
+struct SharedMemory {
+    Frames frames;
+    vector<unordered_map<Page, Page>> wide;
+    Page nextWide = -1;
+    SharedMemory(int capacity, int processes) : frames(capacity), wide(processes) {}
+    bool access(int pid, Page page) {
+        if ((uint64_t)page < (1ULL << 55) && pid < 256) return frames.access(page << 8 | pid);
+        auto [it, fresh] = wide[pid].try_emplace(page, nextWide);
+        if (fresh) nextWide--;
+        return frames.access(it->second);
+    }
+};
+
+// Local replacement: memory is split evenly and each process only replaces
+// pages within its own partition
+template <class Frames>
+struct PartitionedMemory {
+    vector<Frames> parts;
+    PartitionedMemory(int capacity, int processes) {
+        for (int p = 0; p < processes; p++) parts.emplace_back(capacity / processes + (p < capacity % processes));
+    }
+    bool access(int pid, Page page) { return parts[pid].access(page); }
+};
+
+// Per-process fault counts. Each process's own references are cut into
+// windows, and a window whose fault ratio exceeds the threshold is thrashing.
+struct ProcessFaults {
+    long long refs = 0, faults = 0, windows = 0, thrashing = 0;
+    long long inWindow = 0, windowFaults = 0;
+
+    void record(bool hit, int window, double threshold) {
+        refs++;
+        faults += !hit;
+        windowFaults += !hit;
+        if (++inWindow == window) {
+            windows++;
+            thrashing += windowFaults > threshold * window;
+            inWindow = windowFaults = 0;
+        }
+    }
+};
+
+// Global vs local LRU and CLOCK over the interleaved traces, all four fed
+// from one merge pass
+template <class Trace>
+void multiReport(const vector<const Trace *> &traces, int capacity, int quantum, int window, double threshold) {
+    int k = traces.size();
+    SharedMemory<LruFrames> globalLru(capacity, k);
+    PartitionedMemory<LruFrames> localLru(capacity, k);
+    SharedMemory<ClockFrames> globalClock(capacity, k);
+    PartitionedMemory<ClockFrames> localClock(capacity, k);
+    vector<string> names = {"Global LRU", "Local LRU", "Global CLOCK", "Local CLOCK"};
+    vector<vector<ProcessFaults>> stats(names.size(), vector<ProcessFaults>(k));
+    interleave(traces, quantum, [&](int pid, Page page) {
+        stats[0][pid].record(globalLru.access(pid, page), window, threshold);
+        stats[1][pid].record(localLru.access(pid, page), window, threshold);
+        stats[2][pid].record(globalClock.access(pid, page), window, threshold);
+        stats[3][pid].record(localClock.access(pid, page), window, threshold);
+    });
+
+    cout << "\n=== " << k << " processes sharing " << capacity << " frames, "
+         << (quantum > 0 ? "round robin (quantum " + to_string(quantum) + ")" : string("timestamp merge"))
+         << "; thrashing = over " << setprecision(6) << 100 * threshold << "% faults in " << window << " references ===\n";
+    cout << left << setw(14) << "Policy" << right << setw(12) << "Faults" << setw(12) << "Miss ratio"
+         << setw(20) << "Thrashing windows" << "\n";
+    for (size_t c = 0; c < names.size(); c++) {
+        long long refs = 0, faults = 0, windows = 0, thrashing = 0;
+        for (auto &st : stats[c]) refs += st.refs, faults += st.faults, windows += st.windows, thrashing += st.thrashing;
+        cout << left << setw(14) << names[c] << right << setw(12) << faults << fixed << setprecision(4)
+             << setw(12) << (double)faults / max(refs, 1LL) << setw(20)
+             << to_string(thrashing) + "/" + to_string(windows) << "\n";
+        cout.unsetf(ios::fixed);
+    }
+    cout << "Faults per process (thrashing windows in brackets):\n" << left << setw(8) << "Process" << right
+         << setw(10) << "Refs";
+    for (auto &name : names) cout << setw(18) << name;
+    cout << "\n";
+    for (int p = 0; p < k; p++) {
+        cout << left << setw(8) << p << right << setw(10) << stats[0][p].refs;
+        for (auto &col : stats) cout << setw(18) << to_string(col[p].faults) + " (" + to_string(col[p].thrashing) + ")";
+        cout << "\n";
+    }
+}
+
+// Set-associative cache of translation tags: `sets` (a power of two) sets of
+// `ways` entries, each set replaced by LRU, FIFO or random, with a value per
+// entry. The TLB (tag = virtual page) and each level of the page-walk cache
+// (tag = VPN prefix, value = next table node) are one of these. ways = 0
+// disables it.
+struct TagCache {
+    enum Policy { LRU, FIFO, RANDOM };
+    int sets, ways;
+    Policy policy;
+    vector<Page> tags;              // -1: invalid
+    vector<int64_t> values;
+    vector<uint64_t> stamp;         // last use (LRU) or fill time (FIFO)
+    uint64_t tick = 0, rng = 0x9E3779B97F4A7C15ULL;
 
-    for (int p : pages) {
-        if (find(frames.begin(), frames.end(), p) == frames.end()) {
-            if (frames.size() < capacity) {
-                frames.push_back(p);
-                q.push(p);
-            } else {
-                int victim = q.front();
-                q.pop();
-                q.push(p);
-                replace(frames.begin(), frames.end(), victim, p);
+    TagCache(int sets, int ways, Policy policy)
+        : sets(sets), ways(ways), policy(policy), tags((size_t)sets * ways, -1), values(tags.size()),
+          stamp(tags.size(), 0) {}
+
+    int find(Page tag) const {
+        int base = (tag & (sets - 1)) * ways;
+        for (int w = base; w < base + ways; w++)
+            if (tags[w] == tag) return w;
+        return -1;
+    }
+    // Entry holding tag, or -1
+    int lookup(Page tag) {
+        int w = find(tag);
+        if (w >= 0 && policy == LRU) stamp[w] = ++tick;
+        return w;
+    }
+    void fill(Page tag, int64_t value = 0) {
+        if (!ways) return;
+        int base = (tag & (sets - 1)) * ways, victim = base;
+        if (policy == RANDOM) {
+            rng ^= rng << 13, rng ^= rng >> 7, rng ^= rng << 17;
+            victim = base + rng % ways;
+        }
+        for (int w = base; w < base + ways; w++) {
+            if (tags[w] < 0) {
+                victim = w;
+                break;
             }
-            faults++;
-            cout << "Page " << p << " -> ";
-            display(frames);
+            if (policy != RANDOM && stamp[w] < stamp[victim]) victim = w;
+        }
+        tags[victim] = tag;
+        values[victim] = value;
+        stamp[victim] = ++tick;
+    }
+    bool invalidate(Page tag) {
+        int w = find(tag);
+        if (w >= 0) tags[w] = -1;
+        return w >= 0;
+    }
+};
+
+struct TranslationStats {
+    long long refs = 0, tlbHits = 0, walks = 0, walkAccesses = 0, pwcHits = 0;
+    long long faults = 0, evictions = 0, shootdowns = 0, tableNodes = 0;
+};
+
+// Address translation in front of a replacement engine (one with `slot`:
+// LruFrames, FifoFrames, ClockFrames). A TLB miss walks a 4-level radix page
+// table of 512-entry nodes indexed by 9-bit slices of the VPN, as on x86-64.
+// The page-walk cache holds upper-level entries keyed by VPN prefix (4-way
+// sets), so a walk resumes at the node below the deepest cached level. A
+// leaf that is not present is a page fault: the engine loads the page, the
+// victim's PTE is cleared and its TLB entry shot down. Every reference also
+// goes to the engine, so fault counts match the plain simulation. The
+// retried walk after a fault is not counted (the handler fills the TLB).
+template <class Frames>
+struct TranslationSim {
+    static constexpr int LEVELS = 4, FANOUT = 512;
+    TagCache tlb;
+    vector<TagCache> pwc;           // entries read at levels 0..2, keyed vpn >> 27 / 18 / 9
+    vector<int32_t> table;          // nodes of FANOUT entries; node 0 is the root.
+                                    // upper levels: child node (0 = none), leaf: present
+    Frames frames;
+    vector<Page> slotPage;          // page in each engine slot, to find the victim
+    vector<size_t> slotPte;         // and its leaf entry in `table`
+    TranslationStats st;
+
+    TranslationSim(int capacity, int tlbSets, int tlbWays, TagCache::Policy tlbPolicy, int pwcEntries)
+        : tlb(tlbSets, tlbWays, tlbPolicy), table(FANOUT, 0), frames(capacity), slotPage(capacity, -1),
+          slotPte(capacity) {
+        int ways = min(pwcEntries, 4), sets = ways ? pwcEntries / ways : 1;
+        while (sets & (sets - 1)) sets &= sets - 1;
+        for (int l = 0; l < LEVELS - 1; l++) pwc.emplace_back(sets, ways, TagCache::LRU);
+        st.tableNodes = 1;
+    }
+
+    static int index(Page vpn, int level) { return vpn >> (9 * (LEVELS - 1 - level)) & (FANOUT - 1); }
+    // Leaf entry of vpn, allocating the missing nodes
+    size_t leaf(Page vpn) {
+        int node = 0;
+        for (int l = 0; l < LEVELS - 1; l++) {
+            size_t e = (size_t)node * FANOUT + index(vpn, l);
+            if (!table[e]) {
+                table[e] = st.tableNodes++;
+                table.resize((size_t)st.tableNodes * FANOUT, 0);
+            }
+            node = table[e];
+        }
+        return (size_t)node * FANOUT + index(vpn, LEVELS - 1);
+    }
+    // Hardware walk: memory reads from the first uncached level down to the
+    // leaf or the first missing entry. Returns whether the page is present.
+    bool walk(Page vpn) {
+        st.walks++;
+        int start = 0, node = 0;
+        for (int l = LEVELS - 2; l >= 0; l--) {
+            int w = pwc[l].lookup(vpn >> (9 * (LEVELS - 1 - l)));
+            if (w >= 0) {
+                start = l + 1;
+                node = pwc[l].values[w];
+                st.pwcHits++;
+                break;
+            }
+        }
+        for (int l = start; l < LEVELS; l++) {
+            int32_t entry = table[(size_t)node * FANOUT + index(vpn, l)];
+            st.walkAccesses++;
+            if (!entry || l == LEVELS - 1) return entry;
+            pwc[l].fill(vpn >> (9 * (LEVELS - 1 - l)), entry);
+            node = entry;
+        }
+        return false;
+    }
+    void access(Page vpn) {
+        st.refs++;
+        if (tlb.lookup(vpn) >= 0) {
+            st.tlbHits++;
+            frames.access(vpn);             // resident: the TLB only maps loaded pages
+            return;
+        }
+        bool present = walk(vpn);
+        frames.access(vpn);                 // faults exactly when !present
+        if (!present) {
+            st.faults++;
+            int f = frames.slot;
+            if (slotPage[f] >= 0) {
+                st.evictions++;
+                table[slotPte[f]] = 0;
+                st.shootdowns += tlb.invalidate(slotPage[f]);
+            }
+            slotPage[f] = vpn;
+            slotPte[f] = leaf(vpn);
+            table[slotPte[f]] = 1;
+        }
+        tlb.fill(vpn);
+    }
+};
+
+// One translation run per replacement policy over the same trace
+template <class Range>
+void translationReport(const Range &pages, int capacity, const vector<string> &policies, int tlbSets,
+                       int tlbWays, TagCache::Policy tlbPolicy, int pwcEntries) {
+    const char *tlbNames[] = {"LRU", "FIFO", "random"};
+    cout << "\n=== TLB " << tlbSets << " sets x " << tlbWays << " ways (" << tlbNames[tlbPolicy]
+         << "), page-walk cache " << pwcEntries << " entries/level, " << capacity << " frames ===\n";
+    cout << left << setw(8) << "Policy" << right << setw(12) << "TLB hits" << setw(10) << "Hit %"
+         << setw(10) << "Walks" << setw(12) << "Walk reads" << setw(10) << "Per walk" << setw(10)
+         << "PWC hits" << setw(10) << "Faults" << setw(12) << "Shootdowns" << setw(11) << "Table KB"
+         << "\n";
+    auto run = [&](const string &name, auto sim) {
+        for (Page p : pages) {
+            if (p >> 36) {
+                cerr << "page " << p << " is beyond the 48-bit address space of a 4-level table\n";
+                return;
+            }
+            sim.access(p);
+        }
+        auto &st = sim.st;
+        cout << left << setw(8) << name << right << setw(12) << st.tlbHits << fixed << setprecision(2)
+             << setw(10) << 100.0 * st.tlbHits / max(st.refs, 1LL) << setw(10) << st.walks << setw(12)
+             << st.walkAccesses << setw(10) << (double)st.walkAccesses / max(st.walks, 1LL) << setw(10)
+             << st.pwcHits << setw(10) << st.faults << setw(12) << st.shootdowns << setw(11)
+             << st.tableNodes * TranslationSim<LruFrames>::FANOUT * 8 / 1024 << "\n";
+        cout.unsetf(ios::fixed);
+    };
+    for (auto &policy : policies) {
+        if (policy == "lru") run(policy, TranslationSim<LruFrames>(capacity, tlbSets, tlbWays, tlbPolicy, pwcEntries));
+        else if (policy == "fifo") run(policy, TranslationSim<FifoFrames>(capacity, tlbSets, tlbWays, tlbPolicy, pwcEntries));
+        else if (policy == "clock") run(policy, TranslationSim<ClockFrames>(capacity, tlbSets, tlbWays, tlbPolicy, pwcEntries));
+    }
+}
+
+// Prefetchers see every demand reference: the page, whether it faulted and
+// whether it was a prefetched page on its first use. They append the pages
+// they want fetched ahead.
+struct NoPrefetch {
+    void observe(Page, bool, bool, vector<Page> &) {}
+};
+
+// Sequential readahead with an adaptive window, after Linux: a fault on the
+// page following the previous reference starts a stream with the minimum
+// window. When the stream reaches the first page of the last window read
+// (the marker), the next window is read ahead, twice as large up to the
+// maximum. Any other fault drops the window back to the minimum.
+struct ReadaheadPrefetcher {
+    int minWindow, maxWindow, window;
+    Page prev = -2, marker = -1, end = -1;
+
+    ReadaheadPrefetcher(int minWindow, int maxWindow)
+        : minWindow(minWindow), maxWindow(maxWindow), window(minWindow) {}
+
+    void issue(Page from, vector<Page> &out) {
+        for (Page p = from; p < from + window; p++) out.push_back(p);
+        marker = from;
+        end = from + window;
+    }
+    void observe(Page page, bool fault, bool, vector<Page> &out) {
+        if (page == marker) {
+            window = min(2 * window, maxWindow);
+            issue(end, out);
+        } else if (fault) {
+            window = minWindow;
+            if (page == prev + 1) issue(page + 1, out);
+        }
+        prev = page;
+    }
+};
+
+// Stride detection: once the same nonzero distance between consecutive
+// references has been seen twice in a row, fetch the next `degree` pages
+// along it
+struct StridePrefetcher {
+    int degree;
+    bool confirmed = false;
+    Page prev = -1, stride = 0;
+
+    explicit StridePrefetcher(int degree) : degree(degree) {}
+
+    void observe(Page page, bool, bool, vector<Page> &out) {
+        Page d = prev < 0 ? 0 : page - prev;
+        prev = page;
+        if (!d) return;
+        confirmed = d == stride;
+        stride = d;
+        if (confirmed)
+            for (int k = 1; k <= degree; k++)
+                if (page + k * stride >= 0) out.push_back(page + k * stride);
+    }
+};
+
+// Markov predictor: a direct-mapped table (power-of-two entries) remembers
+// the last two distinct pages that followed each page; a reference fetches
+// its page's successors
+struct MarkovPrefetcher {
+    struct Entry { Page tag = -1, next[2] = {-1, -1}; };
+    vector<Entry> table;
+    int shift = 64;
+    Page prev = -1;
+
+    explicit MarkovPrefetcher(int entries) {
+        while (entries > 1 && (1LL << (64 - shift + 1)) <= entries) shift--;
+        table.resize(1ULL << (64 - shift));
+    }
+    Entry &entry(Page page) { return table[shift == 64 ? 0 : ((uint64_t)page * 0x9E3779B97F4A7C15ULL) >> shift]; }
+
+    void observe(Page page, bool, bool, vector<Page> &out) {
+        if (prev >= 0 && prev != page) {
+            Entry &e = entry(prev);
+            if (e.tag != prev) e = {prev, {page, -1}};
+            else if (e.next[0] != page) e.next[1] = e.next[0], e.next[0] = page;
+        }
+        prev = page;
+        Entry &e = entry(page);
+        if (e.tag == page)
+            for (Page next : e.next)
+                if (next >= 0) out.push_back(next);
+    }
+};
+
+struct PrefetchStats {
+    long long refs = 0, faults = 0, issued = 0, useful = 0, wasted = 0;
+};
+
+// Demand references through a slot engine (LruFrames, FifoFrames,
+// ClockFrames) with a prefetcher. Prefetched pages that are not resident
+// enter through the policy's own access(), so they take a normal place in
+// its order. Each slot remembers whether it holds a prefetched page not yet
+// referenced: the first demand hit on it is useful, and eviction (or the end
+// of the trace) before one makes it wasted.
+template <class Frames, class Prefetcher, class Range>
+PrefetchStats prefetchRun(Frames frames, Prefetcher pf, const Range &pages, int capacity) {
+    PrefetchStats st;
+    vector<char> unused(capacity, 0);
+    auto load = [&](bool prefetch) {
+        st.wasted += unused[frames.slot];
+        unused[frames.slot] = prefetch;
+    };
+    vector<Page> fetch;
+    for (Page p : pages) {
+        st.refs++;
+        bool hit = frames.access(p), prefetched = false;
+        if (hit) {
+            prefetched = unused[frames.slot];
+            st.useful += prefetched;
+            unused[frames.slot] = 0;
         } else {
-            cout << "Page " << p << " -> No page fault\n";
+            st.faults++;
+            load(false);
         }
+        fetch.clear();
+        pf.observe(p, !hit, prefetched, fetch);
+        for (Page q : fetch)
+            if (!frames.contains(q)) {
+                frames.access(q);
+                load(true);
+                st.issued++;
+            }
     }
+    for (char u : unused) st.wasted += u;
+    return st;
+}
 
-    cout << "Total Page Faults = " << faults << "\n";
+// Each prefetcher against no prefetching, per replacement policy
+template <class Range>
+void prefetchReport(const Range &pages, int capacity, const vector<string> &policies, int minWindow,
+                    int maxWindow, int degree, int markovEntries) {
+    cout << "\n=== Prefetching, " << capacity << " frames (readahead " << minWindow << "-" << maxWindow
+         << " pages, stride degree " << degree << ", Markov " << markovEntries << " entries) ===\n";
+    cout << left << setw(8) << "Policy" << setw(12) << "Prefetcher" << right << setw(14) << "Demand faults"
+         << setw(11) << "Reduction" << setw(10) << "Issued" << setw(10) << "Useful" << setw(10) << "Wasted"
+         << setw(10) << "Accuracy" << setw(10) << "Coverage" << "\n";
+    auto runAll = [&](const string &policy, auto frames) {
+        long long base = prefetchRun(frames, NoPrefetch(), pages, capacity).faults;
+        auto row = [&](const string &name, const PrefetchStats &st) {
+            cout << left << setw(8) << policy << setw(12) << name << right << setw(14) << st.faults << fixed
+                 << setprecision(1) << setw(10) << 100.0 * (base - st.faults) / max(base, 1LL) << "%"
+                 << setw(10) << st.issued << setw(10) << st.useful << setw(10) << st.wasted << setw(9)
+                 << 100.0 * st.useful / max(st.issued, 1LL) << "%" << setw(9)
+                 << 100.0 * st.useful / max(base, 1LL) << "%\n";
+            cout.unsetf(ios::fixed);
+        };
+        row("none", PrefetchStats{0, base});
+        row("readahead", prefetchRun(frames, ReadaheadPrefetcher(minWindow, maxWindow), pages, capacity));
+        row("stride", prefetchRun(frames, StridePrefetcher(degree), pages, capacity));
+        row("markov", prefetchRun(frames, MarkovPrefetcher(markovEntries), pages, capacity));
+    };
+    for (auto &policy : policies) {
+        if (policy == "lru") runAll(policy, LruFrames(capacity));
+        else if (policy == "fifo") runAll(policy, FifoFrames(capacity));
+        else if (policy == "clock") runAll(policy, ClockFrames(capacity));
+    }
 }
 
-// LRU Page Replacement
-void lru(vector<int> pages, int capacity) {
-    cout << "\n=== LRU Page Replacement ===\n";
-    vector<int> frames;
-    unordered_map<int, int> lastUsed;
-    int faults = 0, time = 0;
+// Scan-heavy synthetic trace: sequential runs of 50-500 pages from random
+// points of a large file, between random lookups in a hot set of 200 pages
+vector<int> scanTrace(int scans, unsigned seed) {
+    mt19937 gen(seed);
+    vector<int> pages;
+    for (int s = 0; s < scans; s++) {
+        int start = gen() % 1000000, length = 50 + gen() % 451;
+        for (int i = 0; i < length; i++) pages.push_back(start + i);
+        for (int i = gen() % 200; i > 0; i--) pages.push_back(2000000 + gen() % 200);
+    }
+    return pages;
+}
 
-    for (int p : pages) {
-        time++;
-        if (find(frames.begin(), frames.end(), p) == frames.end()) {
-            if (frames.size() < capacity)
-                frames.push_back(p);
-            else {
-                int lruPage = frames[0], minTime = INT_MAX;
-                for (int f : frames) {
-                    if (lastUsed[f] < minTime) {
-                        minTime = lastUsed[f];
-                        lruPage = f;
-                    }
+// Binary page-reference trace (.pgt)
+// Header, 20 bytes little-endian:
+//   char     magic[4]  "PGTR"
+//   uint16   version   1
+//   uint16   flags     bit 0: 64-bit pages (else 32-bit)
+//                      bit 1: delta + varint (zigzag deltas from the previous
+//                             page, LEB128; the first delta is from 0)
+//                      bit 2: write flags; each stored value is
+//                             page << 1 | write
+//   uint64   count     number of references
+//   uint32   reserved  0
+// Body: `count` packed page numbers, or `count` varints.
+const uint16_t TRACE_WIDE = 1, TRACE_VARINT = 2, TRACE_WRITES = 4;
+
+struct TraceHeader {
+    char magic[4];
+    uint16_t version, flags;
+    uint64_t count;
+    uint32_t reserved;
+} __attribute__((packed));
+
+template <class Range>
+bool writeTrace(const string &path, const Range &pages, uint16_t flags) {
+    BufferedWriter out(path);
+    if (!out.ok()) {
+        cerr << "cannot write " << path << "\n";
+        return false;
+    }
+    TraceHeader h{{'P', 'G', 'T', 'R'}, 1, flags, 0, 0};
+    out.put(&h, sizeof h);          // count is patched in at the end
+    Page prev = 0;
+    for (auto x : pages) {
+        Ref r = asRef(x);
+        Page p = flags & TRACE_WRITES ? r.page * 2 + r.write : r.page;
+        if (flags & TRACE_VARINT) {
+            int64_t d = p - prev;
+            uint64_t z = ((uint64_t)d << 1) ^ (uint64_t)(d >> 63);
+            for (; z >= 0x80; z >>= 7) out.putByte((uint8_t)z | 0x80);
+            out.putByte((uint8_t)z);
+            prev = p;
+        } else if (flags & TRACE_WIDE) {
+            uint64_t v = p;
+            out.put(&v, 8);
+        } else {
+            if (p < 0 || p > UINT32_MAX) {
+                cerr << "page " << p << " does not fit a 32-bit trace; use 64-bit or varint\n";
+                return false;
+            }
+            uint32_t v = p;
+            out.put(&v, 4);
+        }
+        h.count++;
+    }
+    out.patch(0, &h, sizeof h);
+    return out.finish();
+}
+
+// Reads a .pgt trace as a range of Page. By default the body is mmapped and
+// decoded in place; with `stream` set (or when mmap fails) it is read in
+// 4 MiB blocks. Either way no vector of the trace is built. On a regular
+// file each begin() starts an independent pass, so two-pass users like
+// optimal() simply iterate twice. A pipe (or any non-seekable input) is
+// read once from the descriptor the header came from: only the first pass
+// sees references, so callers check seekable() before a second one. There
+// the header count is not verified up front; size() drops whatever the body
+// turned out to be short of once the pass has ended.
+class TraceReader {
+    struct Block {                 // streaming source for one pass
+        FILE *f;
+        vector<uint8_t> buf;
+        Block(const string &path) : f(fopen(path.c_str(), "rb")), buf(4 << 20) {
+            if (f) fseek(f, sizeof(TraceHeader), SEEK_SET);
+        }
+        Block(int fd) : f(fdopen(fd, "rb")), buf(4 << 20) {}
+        ~Block() { if (f) fclose(f); }
+        // Keep the unread tail [p, end) and top the buffer up behind it
+        void refill(const uint8_t *&p, const uint8_t *&end) {
+            size_t keep = end - p;
+            memmove(buf.data(), p, keep);
+            size_t got = f ? fread(buf.data() + keep, 1, buf.size() - keep, f) : 0;
+            p = buf.data();
+            end = p + keep + got;
+        }
+    };
+
+    string path;
+    TraceHeader header{};
+    const uint8_t *map = nullptr;
+    size_t mapLen = 0;
+    bool streaming = false, pipeInput = false;
+    mutable int pipeFd = -1;       // non-seekable input, until its one pass takes it
+    mutable uint64_t missing = 0;  // references the header promised but the pipe lacked
+    string err;
+
+    // read() until n bytes or EOF; pipes hand data over in pieces
+    static size_t readFully(int fd, void *out, size_t n) {
+        size_t got = 0;
+        for (ssize_t r; got < n && (r = read(fd, (char *)out + got, n - got)) > 0;) got += r;
+        return got;
+    }
+
+public:
+    explicit TraceReader(const string &path, bool stream = false) : path(path) {
+        int fd = open(path.c_str(), O_RDONLY);
+        if (fd < 0) {
+            err = "cannot open " + path;
+            return;
+        }
+        if (readFully(fd, &header, sizeof header) != sizeof header || memcmp(header.magic, "PGTR", 4) != 0 ||
+            header.version != 1) {
+            err = path + " is not a version 1 page trace";
+            close(fd);
+            return;
+        }
+        struct stat st;
+        bool regular = fstat(fd, &st) == 0 && S_ISREG(st.st_mode);
+        if (regular) {
+            // Every reference takes at least one body byte (varint) or the
+            // full width; a count the file cannot hold means it was cut short
+            uint64_t body = st.st_size - sizeof header;
+            uint64_t fits = header.flags & TRACE_VARINT ? body : body / (header.flags & TRACE_WIDE ? 8 : 4);
+            if (header.count > fits) {
+                err = path + " is truncated: header says " + to_string(header.count) +
+                      " references, the body holds at most " + to_string(fits);
+                close(fd);
+                return;
+            }
+        }
+        if (!stream && regular) {
+            void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m != MAP_FAILED) {
+                map = (const uint8_t *)m;
+                mapLen = st.st_size;
+                madvise(m, mapLen, MADV_SEQUENTIAL);
+            }
+        }
+        streaming = map == nullptr;
+        if (regular)
+            close(fd);
+        else
+            pipeInput = true, pipeFd = fd;  // positioned just past the header
+    }
+    ~TraceReader() {
+        if (map) munmap((void *)map, mapLen);
+        if (pipeFd >= 0) close(pipeFd);
+    }
+    TraceReader(const TraceReader &) = delete;
+    TraceReader &operator=(const TraceReader &) = delete;
+
+    bool ok() const { return err.empty(); }
+    const string &error() const { return err; }
+    size_t size() const { return ok() ? header.count - missing : 0; }
+    bool seekable() const { return ok() && !pipeInput; }
+    bool hasWrites() const { return header.flags & TRACE_WRITES; }
+
+    class iterator {
+        const uint8_t *p = nullptr, *end = nullptr;
+        shared_ptr<Block> block;
+        uint16_t flags = 0;
+        uint64_t left = 0;         // references not yet consumed, current included
+        uint64_t *missing = nullptr;
+        Page cur = 0;
+
+        void shortRead() {
+            if (missing) *missing = left;
+            left = 0;
+        }
+
+        // Decodes the next reference into cur. A body shorter than the
+        // count (a file cut while being read, or a pipe) ends the range.
+        void decode() {
+            if (block && end - p < 10) block->refill(p, end);
+            if (flags & TRACE_VARINT) {
+                uint64_t z = 0;
+                bool done = false;
+                for (int shift = 0; p < end && shift < 64 && !done; shift += 7) {
+                    uint8_t b = *p++;
+                    z |= (uint64_t)(b & 0x7F) << shift;
+                    done = !(b & 0x80);
                 }
-                replace(frames.begin(), frames.end(), lruPage, p);
+                if (!done) {
+                    shortRead();
+                    return;
+                }
+                cur += (int64_t)(z >> 1) ^ -(int64_t)(z & 1);
+            } else if (flags & TRACE_WIDE) {
+                uint64_t v;
+                if (end - p < 8) {
+                    shortRead();
+                    return;
+                }
+                memcpy(&v, p, 8);
+                p += 8;
+                cur = v;
+            } else {
+                uint32_t v;
+                if (end - p < 4) {
+                    shortRead();
+                    return;
+                }
+                memcpy(&v, p, 4);
+                p += 4;
+                cur = v;
             }
-            faults++;
-            cout << "Page " << p << " -> ";
-            display(frames);
-        } else {
-            cout << "Page " << p << " -> No page fault\n";
         }
-        lastUsed[p] = time;
+
+    public:
+        using iterator_category = input_iterator_tag;
+        using value_type = Page;
+        using difference_type = ptrdiff_t;
+        using pointer = const Page *;
+        using reference = Page;
+
+        iterator() = default;
+        iterator(const TraceReader &r) : flags(r.header.flags), left(r.header.count) {
+            if (r.pipeInput) {
+                if (r.pipeFd < 0) {    // the one pass a pipe allows is used up
+                    left = 0;
+                    return;
+                }
+                block = make_shared<Block>(r.pipeFd);
+                r.pipeFd = -1;         // the block's FILE closes it
+                missing = &r.missing;
+                p = end = block->buf.data();
+            } else if (r.streaming) {
+                block = make_shared<Block>(r.path);
+                p = end = block->buf.data();
+            } else {
+                p = r.map + sizeof(TraceHeader);
+                end = r.map + r.mapLen;
+            }
+            if (left) decode();
+        }
+        Page operator*() const { return flags & TRACE_WRITES ? cur >> 1 : cur; }
+        bool isWrite() const { return flags & TRACE_WRITES && cur & 1; }
+        iterator &operator++() {
+            if (--left) decode();
+            return *this;
+        }
+        bool operator==(const iterator &o) const { return left == o.left; }
+        bool operator!=(const iterator &o) const { return left != o.left; }
+    };
+
+    iterator begin() const { return ok() ? iterator(*this) : iterator(); }
+    iterator end() const { return iterator(); }
+};
+
+// Text trace (whitespace-separated page numbers) -> .pgt, streamed.
+// A page number may carry a "w" suffix ("7w") to mark a write.
+struct TextPages {
+    string path;
+    struct iterator {
+        shared_ptr<ifstream> in;
+        Ref cur{0, false};
+        bool done = true;
+        Ref operator*() const { return cur; }
+        iterator &operator++() {
+            string token;
+            done = !(*in >> token);
+            if (!done) cur = {stoll(token), token.back() == 'w' || token.back() == 'W'};
+            return *this;
+        }
+        bool operator!=(const iterator &o) const { return done != o.done; }
+    };
+    iterator begin() const {
+        iterator it{make_shared<ifstream>(path)};
+        return ++it;
     }
+    iterator end() const { return {}; }
+};
 
-    cout << "Total Page Faults = " << faults << "\n";
-}
+// Raw address traces -> page references.
+// Two input formats:
+//   Lackey text (valgrind --tool=lackey --trace-mem=yes): lines like
+//     "I  0400d7d4,8", " L 7ff000398,8", " S ...", " M ..."; any other line
+//     (the ==pid== banner, program output) is skipped.
+//   Binary: little-endian uint64 records, the access type in the top two
+//     bits (0 = I, 1 = L, 2 = S, 3 = M) and the address in the low 62.
+// Each access becomes the page(s) it touches (addr >> pageShift, plus the
+// next page when it straddles a boundary). A modify counts as a load and a
+// store, and stores are writes. Only the selected streams are kept, and a
+// page repeating the previous kept reference is collapsed unless it turns a
+// read into a write: the repeat is a hit that cannot change the faults of
+// FIFO, LRU, CLOCK or OPT (frequency-aware policies see one reference per
+// run of the same page).
+const uint8_t STREAM_I = 1, STREAM_L = 2, STREAM_S = 4;
 
-// Optimal Page Replacement
-void optimal(vector<int> pages, int capacity) {
-    cout << "\n=== Optimal Page Replacement ===\n";
-    vector<int> frames;
-    int faults = 0;
+class AddressPages {
+    string path, err;
+    const char *map = nullptr;
+    size_t mapLen = 0;
+    bool binary;
+    int shift;
+    uint8_t streams;
+    mutable long long count = -1;
 
-    for (int i = 0; i < pages.size(); i++) {
-        int p = pages[i];
-        if (find(frames.begin(), frames.end(), p) == frames.end()) {
-            if (frames.size() < capacity)
-                frames.push_back(p);
+public:
+    AddressPages(const string &path, bool binary, int pageShift, uint8_t streams)
+        : path(path), binary(binary), shift(pageShift), streams(streams) {
+        int fd = open(path.c_str(), O_RDONLY);
+        struct stat st;
+        if (fd < 0 || fstat(fd, &st) != 0) {
+            err = "cannot open " + path;
+            if (fd >= 0) close(fd);
+            return;
+        }
+        if (st.st_size > 0) {
+            void *m = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (m == MAP_FAILED) err = "cannot map " + path;
             else {
-                int victim = -1, farthest = i + 1;
-                for (int f : frames) {
-                    int j;
-                    for (j = i + 1; j < pages.size(); j++)
-                        if (pages[j] == f) break;
-                    if (j == pages.size()) {
-                        victim = f;
-                        break;
-                    }
-                    if (j > farthest) {
-                        farthest = j;
-                        victim = f;
+                map = (const char *)m;
+                mapLen = st.st_size;
+                madvise(m, mapLen, MADV_SEQUENTIAL);
+            }
+        }
+        close(fd);
+    }
+    ~AddressPages() {
+        if (map) munmap((void *)map, mapLen);
+    }
+    AddressPages(const AddressPages &) = delete;
+    AddressPages &operator=(const AddressPages &) = delete;
+
+    bool ok() const { return err.empty(); }
+    const string &error() const { return err; }
+
+    class iterator {
+        const char *p = nullptr, *end = nullptr;
+        bool binary = false, done = true, pending = false, write = false, lastWrite = false;
+        int shift = 12;
+        uint8_t streams = 0;
+        Page cur = 0, last = -1, spill = 0;
+
+        static int hexDigit(char c) {
+            if (c >= '0' && c <= '9') return c - '0';
+            c |= 0x20;
+            return c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1;
+        }
+        // Next access in a selected stream: its address, size and type bits
+        bool nextAccess(uint64_t &addr, uint64_t &size, uint8_t &type) {
+            while (p < end) {
+                if (binary) {
+                    if (end - p < 8) return p = end, false;
+                    uint64_t r;
+                    memcpy(&r, p, 8);
+                    p += 8;
+                    static const uint8_t kinds[4] = {STREAM_I, STREAM_L, STREAM_S, STREAM_L | STREAM_S};
+                    type = kinds[r >> 62];
+                    addr = r & ((1ULL << 62) - 1);
+                    size = 1;
+                } else {
+                    const char *line = p;
+                    const char *eol = (const char *)memchr(p, '\n', end - p);
+                    p = eol ? eol + 1 : end;
+                    while (line < p && *line == ' ') line++;
+                    char k = line < p ? *line : 0;
+                    type = k == 'I' ? STREAM_I : k == 'L' ? STREAM_L : k == 'S' ? STREAM_S
+                         : k == 'M' ? STREAM_L | STREAM_S : 0;
+                    if (!type || line + 1 >= p || line[1] != ' ') continue;
+                    line++;
+                    while (line < p && *line == ' ') line++;
+                    addr = 0;
+                    int d, digits = 0;
+                    for (; line < p && (d = hexDigit(*line)) >= 0; line++, digits++) addr = addr << 4 | d;
+                    if (!digits) continue;
+                    size = 0;
+                    if (line < p && *line == ',')
+                        for (line++; line < p && *line >= '0' && *line <= '9'; line++) size = size * 10 + (*line - '0');
+                    size = max<uint64_t>(size, 1);
+                }
+                if (type & streams) return true;
+            }
+            return false;
+        }
+        void advance() {
+            while (true) {
+                Page page;
+                if (pending) {
+                    pending = false;
+                    page = spill;
+                } else {
+                    uint64_t addr, size;
+                    uint8_t type;
+                    if (!nextAccess(addr, size, type)) {
+                        done = true;
+                        return;
                     }
+                    write = type & STREAM_S;
+                    page = addr >> shift;
+                    Page lastByte = (addr + size - 1) >> shift;
+                    if (lastByte != page) pending = true, spill = lastByte;
+                }
+                if (page != last || (write && !lastWrite)) {
+                    cur = last = page;
+                    lastWrite = write;
+                    return;
                 }
-                replace(frames.begin(), frames.end(), victim, p);
             }
-            faults++;
-            cout << "Page " << p << " -> ";
-            display(frames);
-        } else {
-            cout << "Page " << p << " -> No page fault\n";
         }
+
+    public:
+        using iterator_category = input_iterator_tag;
+        using value_type = Page;
+        using difference_type = ptrdiff_t;
+        using pointer = const Page *;
+        using reference = Page;
+
+        iterator() = default;
+        iterator(const AddressPages &a)
+            : p(a.map), end(a.map + a.mapLen), binary(a.binary), done(false), shift(a.shift), streams(a.streams) {
+            advance();
+        }
+        Page operator*() const { return cur; }
+        bool isWrite() const { return lastWrite; }
+        iterator &operator++() {
+            advance();
+            return *this;
+        }
+        bool operator==(const iterator &o) const { return done == o.done; }
+        bool operator!=(const iterator &o) const { return done != o.done; }
+    };
+
+    iterator begin() const { return map ? iterator(*this) : iterator(); }
+    iterator end() const { return iterator(); }
+    // References after collapsing; the first call makes a counting pass
+    size_t size() const {
+        if (count < 0) {
+            count = 0;
+            for (auto it = begin(); it != end(); ++it) count++;
+        }
+        return count;
     }
+};
+
+// "4K", "2M", "1G" or a byte count -> page shift; -1 unless a power of two
+int pageShiftOf(const string &size) {
+    if (size.empty() || !isdigit((unsigned char)size[0])) return -1;
+    size_t used;
+    unsigned long long bytes = stoull(size, &used);
+    string unit = size.substr(used);
+    if (unit == "K" || unit == "k") bytes <<= 10;
+    else if (unit == "M" || unit == "m") bytes <<= 20;
+    else if (unit == "G" || unit == "g") bytes <<= 30;
+    else if (!unit.empty()) return -1;
+    if (!bytes || (bytes & (bytes - 1))) return -1;
+    return __builtin_ctzll(bytes);
+}
+
+// Reads a trace as Ref, taking the write flag from its iterator
+template <class Trace>
+struct WithWrites {
+    const Trace &trace;
+    struct iterator {
+        typename Trace::iterator it;
+        Ref operator*() const { return {*it, it.isWrite()}; }
+        iterator &operator++() {
+            ++it;
+            return *this;
+        }
+        bool operator!=(const iterator &o) const { return it != o.it; }
+    };
+    iterator begin() const { return {trace.begin()}; }
+    iterator end() const { return {trace.end()}; }
+    size_t size() const { return trace.size(); }
+};
+
+// Clean vs dirty evictions and modelled I/O time per policy, over a range
+// of Ref; Enhanced CLOCK is the clean-first policy
+template <class Range>
+void dirtyReport(const Range &refs, int capacity, const IoCost &io) {
+    cout << "\n=== Write-back cost, " << capacity << " frames (read " << io.readSeconds * 1e6
+         << " us, write " << io.writeSeconds * 1e6 << " us) ===\n";
+    cout << left << setw(16) << "Policy" << right << setw(12) << "Faults" << setw(12) << "Clean ev."
+         << setw(12) << "Dirty ev." << setw(12) << "Dirty left" << setw(14) << "I/O ms" << "\n";
+    auto row = [&](const string &name, auto engine) {
+        WriteBackStats st = writeBack(engine, refs);
+        cout << left << setw(16) << name << right << setw(12) << st.faults << setw(12) << st.cleanEvictions
+             << setw(12) << st.dirtyEvictions << setw(12) << st.dirtyResident << setw(14) << fixed
+             << setprecision(3) << st.ioSeconds(io) * 1e3 << "\n";
+        cout.unsetf(ios::fixed);
+    };
+    row("FIFO", WriteBack<FifoFrames>(FifoFrames(capacity), capacity));
+    row("LRU", WriteBack<LruFrames>(LruFrames(capacity), capacity));
+    row("CLOCK", WriteBack<ClockFrames>(ClockFrames(capacity), capacity));
+    row("Second Chance", WriteBack<SecondChanceFrames>(SecondChanceFrames(capacity), capacity));
+    row("GCLOCK", WriteBack<GClockFrames>(GClockFrames(capacity), capacity));
+    row("Enhanced CLOCK", EnhancedClockFrames(capacity));
+    vector<long long> next = nextUses(refs);
+    row("Optimal", WriteBack<OptimalFrames>(OptimalFrames(next, capacity), capacity));
+}
+
+// Policy x capacity sweep. Every policy is dispatched by name to its engine
+// and run through a sink (counting only by default); "opt" shares one
+// next-use table across capacities.
+const vector<string> SWEEP_POLICIES = {"fifo", "lru", "mru", "clock", "second-chance", "gclock",
+                                       "arc", "2q", "car", "lirs", "w-tinylfu", "opt"};
+
+template <class Range, class Sink = CountSink>
+long long policyFaults(const string &policy, const Range &pages, int capacity,
+                       const vector<long long> &next, Sink &&sink = Sink()) {
+    auto run = [&](const string &name, auto frames) { return simulate(name, frames, pages, sink); };
+    if (policy == "fifo") return run("FIFO", FifoFrames(capacity));
+    if (policy == "lru") return run("LRU", LruFrames(capacity));
+    if (policy == "mru") return run("MRU", MruFrames(capacity));
+    if (policy == "clock") return run("CLOCK", ClockFrames(capacity));
+    if (policy == "second-chance") return run("Second Chance", SecondChanceFrames(capacity));
+    if (policy == "gclock") return run("GCLOCK", GClockFrames(capacity));
+    if (policy == "arc") return run("ARC", ArcFrames(capacity));
+    if (policy == "2q") return run("2Q", TwoQFrames(capacity));
+    if (policy == "car") return run("CAR", CarFrames(capacity));
+    if (policy == "lirs") return run("LIRS", LirsFrames(capacity));
+    if (policy == "w-tinylfu") return run("W-TinyLFU", TinyLfuFrames(capacity));
+    if (policy == "opt") return run("Optimal", OptimalFrames(next, capacity));
+    return -1;
+}
+
+struct SweepCell {
+    string policy;
+    int capacity;
+    long long faults;
+    double seconds;
+};
+
+// Runs every (policy, capacity) cell on a pool of worker threads. Workers
+// claim cells through an atomic index, biggest capacities first so the long
+// cells do not end up last, and each walks the shared read-only trace with
+// its own iterator (an mmap cursor, or a private buffer when streaming).
+template <class Range>
+vector<SweepCell> sweep(const Range &pages, const vector<string> &policies, vector<int> capacities,
+                        int threads) {
+    vector<long long> next;
+    if (find(policies.begin(), policies.end(), "opt") != policies.end()) next = nextUses(pages);
+
+    sort(capacities.rbegin(), capacities.rend());
+    vector<SweepCell> cells;
+    for (int c : capacities)
+        for (auto &p : policies) cells.push_back({p, c, 0, 0});
+
+    atomic<size_t> nextCell{0};
+    auto worker = [&] {
+        for (size_t k; (k = nextCell++) < cells.size();) {
+            auto start = chrono::steady_clock::now();
+            cells[k].faults = policyFaults(cells[k].policy, pages, cells[k].capacity, next);
+            cells[k].seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+        }
+    };
+    vector<thread> pool;
+    for (size_t t = 1; t < min<size_t>(max(threads, 1), cells.size()); t++) pool.emplace_back(worker);
+    worker();
+    for (auto &t : pool) t.join();
+
+    sort(cells.begin(), cells.end(), [&](auto &a, auto &b) {
+        if (a.policy != b.policy)
+            return find(policies.begin(), policies.end(), a.policy) < find(policies.begin(), policies.end(), b.policy);
+        return a.capacity < b.capacity;
+    });
+    return cells;
+}
 
-    cout << "Total Page Faults = " << faults << "\n";
+// One row per policy, one faults / hit-ratio column pair per capacity
+void printSweep(const vector<SweepCell> &cells, long long refs, bool json) {
+    vector<int> caps;
+    for (auto &c : cells)
+        if (find(caps.begin(), caps.end(), c.capacity) == caps.end()) caps.push_back(c.capacity);
+    sort(caps.begin(), caps.end());
+    size_t w = caps.size();
+    if (json) {
+        cout << "{\"references\": " << refs << ", \"capacities\": [";
+        for (size_t j = 0; j < w; j++) cout << (j ? ", " : "") << caps[j];
+        cout << "], \"policies\": {";
+        for (size_t r = 0; r < cells.size(); r += w) {
+            cout << (r ? ", " : "") << "\"" << cells[r].policy << "\": {\"faults\": [";
+            for (size_t j = 0; j < w; j++) cout << (j ? ", " : "") << cells[r + j].faults;
+            cout << "], \"hit_ratio\": [";
+            for (size_t j = 0; j < w; j++)
+                cout << (j ? ", " : "") << 1 - (double)cells[r + j].faults / max(refs, 1LL);
+            cout << "]}";
+        }
+        cout << "}}\n";
+        return;
+    }
+    cout << "policy";
+    for (int c : caps) cout << ",faults@" << c << ",hit_ratio@" << c;
+    cout << "\n";
+    for (size_t r = 0; r < cells.size(); r += w) {
+        cout << cells[r].policy;
+        for (size_t j = 0; j < w; j++)
+            cout << "," << cells[r + j].faults << "," << 1 - (double)cells[r + j].faults / max(refs, 1LL);
+        cout << "\n";
+    }
 }
 
 // Main Function
-int main() {
-    vector<int> pages = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2};
-    int capacity = 3;
+// With no arguments, runs the built-in example. Otherwise:
+//   convert TEXT OUT.pgt [--64] [--varint] [--writes]
+//                                             text page list -> binary trace;
+//                                             --writes keeps "7w" write marks
+//   run TRACE.pgt FRAMES [--policies=P,...] [--stream]
+//         [--debug | --events=PREFIX]         fault count per policy; --debug
+//                                             prints every reference, --events
+//                                             writes PREFIX<policy>.pgev logs
+//   mrc TRACE.pgt [MAX_FRAMES] [--stream]     exact LRU miss-ratio curve
+//   mrc TRACE.pgt MAX_FRAMES --shards=RATE [--shards-size=N]
+//                                             sampled (SHARDS) curve in bounded
+//                                             memory, with an error estimate
+//   compare TRACE.pgt FRAMES [--stream]       fault counts only: LRU vs the
+//                                             CLOCK family and the adaptive
+//                                             policies, for large frame counts
+//   sweep TRACE.pgt FRAMES[,FRAMES...] [--policies=P,...] [--threads=N]
+//         [--json] [--stream]                 every policy x capacity in
+//                                             parallel, as a CSV/JSON matrix
+//   ingest ADDRS OUT [--addr=binary] [--page=4K|2M|1G] [--64]
+//                                             address trace -> OUT.i/.l/.s/.all.pgt
+//                                             (with write flags)
+//   dirty TRACE.pgt FRAMES [--read-us=N] [--write-us=N] [--stream]
+//                                             clean/dirty evictions and I/O time
+//   ws TRACE.pgt TAU[,TAU...] [--pff=T,...] [--max-frames=N] [--stream]
+//                                             working-set / PFF allocation vs
+//                                             fixed LRU frames
+//   multi FRAMES TRACE.pgt... [--quantum=N] [--window=N] [--thrash=R] [--stream]
+//                                             one trace per process: global vs
+//                                             local LRU/CLOCK, per-process faults
+//   tlb TRACE.pgt FRAMES [--tlb=SETSxWAYS] [--tlb-policy=lru|fifo|random]
+//       [--pwc=N] [--policies=fifo,lru,clock] [--stream]
+//                                             TLB hits, page-walk reads and
+//                                             faults through a 4-level table
+//   prefetch TRACE.pgt FRAMES [--readahead=MIN,MAX] [--degree=N] [--markov=N]
+//       [--policies=fifo,lru,clock] [--stream]
+//                                             readahead, stride and Markov
+//                                             prefetchers: useful vs wasted
+//   analyze TRACE.pgt [--points=N] [--stream] reuse-distance and gap histograms,
+//                                             footprint, one-hit wonders (JSON)
+// All modes but convert and ingest also read address traces in place of .pgt
+// files with --addr[=lackey|binary] [--page=SIZE] [--streams=ILS].
+int main(int argc, char *argv[]) {
+    if (argc < 2) {
+        vector<int> pages = {7, 0, 1, 2, 0, 3, 0, 4, 2, 3, 0, 3, 2};
+        int capacity = 3;
+
+        fifo(pages, capacity, TextSink());
+        lru(pages, capacity, TextSink());
+        mru(pages, capacity, TextSink());
+        clockReplacement(pages, capacity, TextSink());
+        secondChance(pages, capacity, TextSink());
+        gclock(pages, capacity, TextSink());
+        arc(pages, capacity, TextSink());
+        twoQ(pages, capacity, TextSink());
+        car(pages, capacity, TextSink());
+        lirs(pages, capacity, TextSink());
+        tinyLfu(pages, capacity, TextSink());
+        optimal(pages, capacity, TextSink());
+        if (!engineParity(zipfTrace(3000, 100, 0.8, 5), {1, 2, 3, 8, 32, 100})) return 1;
+
+        // Same string with some references writing their page
+        vector<Ref> refs;
+        set<int> writes = {0, 3, 6, 11};
+        for (int i = 0; i < (int)pages.size(); i++) refs.push_back({pages[i], writes.count(i) > 0});
+        dirtyReport(refs, capacity, IoCost());
+
+        mrc(pages);
+        shardsCheck(zipfTrace(2000000, 500000, 0.9, 1), 100000);
+        allocationReport(phaseTrace(20, 10000, 7), {1000, 4000}, {20, 50});
+
+        // Four processes with their own phases competing for memory
+        vector<vector<int>> procs;
+        for (unsigned seed = 1; seed <= 4; seed++) procs.push_back(phaseTrace(5, 10000, seed));
+        vector<const vector<int> *> procTraces;
+        for (auto &t : procs) procTraces.push_back(&t);
+        multiReport(procTraces, 1000, 0, 1000, 0.5);
+        multiReport(procTraces, 1000, 500, 1000, 0.5);
+
+        translationReport(phaseTrace(20, 10000, 7), 1000, {"fifo", "lru", "clock"}, 16, 4, TagCache::LRU, 32);
+        prefetchReport(scanTrace(500, 11), 1000, {"fifo", "lru", "clock"}, 4, 64, 4, 65536);
+
+        cout << "\n=== Trace profile (phases) ===\n";
+        printProfile(profileTrace(phaseTrace(20, 10000, 7), 10));
+        return 0;
+    }
+
+    string mode = argv[1];
+    vector<string> args;
+    bool wide = false, varint = false, stream = false, json = false, debug = false;
+    bool addr = false, addrBinary = false;
+    int pageShift = 12;
+    uint8_t streams = STREAM_I | STREAM_L | STREAM_S;
+    bool writes = false;
+    IoCost io;
+    string pffList;
+    int maxFrames = 0;
+    int quantum = 0, window = 1000;
+    double thrash = 0.5;
+    int tlbSets = 16, tlbWays = 4, pwcEntries = 32;
+    TagCache::Policy tlbPolicy = TagCache::LRU;
+    int minWindow = 4, maxWindow = 64, degree = 4, markovEntries = 65536;
+    int points = 32;
+    double shardsRate = 0;
+    int shardsSize = 0;
+    string eventsPrefix;
+    vector<string> policies = SWEEP_POLICIES;
+    int threads = max(1u, thread::hardware_concurrency());
+    auto split = [](const string &list) {
+        vector<string> out;
+        stringstream ss(list);
+        for (string item; getline(ss, item, ',');) out.push_back(item);
+        return out;
+    };
+    for (int i = 2; i < argc; i++) {
+        string a = argv[i];
+        if (a == "--64") wide = true;
+        else if (a == "--varint") varint = true;
+        else if (a == "--stream") stream = true;
+        else if (a == "--json") json = true;
+        else if (a == "--debug") debug = true;
+        else if (a.rfind("--events=", 0) == 0) eventsPrefix = a.substr(9);
+        else if (a.rfind("--policies=", 0) == 0) policies = split(a.substr(11));
+        else if (a.rfind("--threads=", 0) == 0) threads = stoi(a.substr(10));
+        else if (a == "--writes") writes = true;
+        else if (a.rfind("--pff=", 0) == 0) pffList = a.substr(6);
+        else if (a.rfind("--max-frames=", 0) == 0) maxFrames = stoi(a.substr(13));
+        else if (a.rfind("--quantum=", 0) == 0) quantum = stoi(a.substr(10));
+        else if (a.rfind("--window=", 0) == 0) window = stoi(a.substr(9));
+        else if (a.rfind("--thrash=", 0) == 0) thrash = stod(a.substr(9));
+        else if (a.rfind("--tlb=", 0) == 0) {
+            // SETSxWAYS
+            size_t x = a.find('x', 6);
+            tlbSets = stoi(a.substr(6, x - 6));
+            tlbWays = x == string::npos ? 1 : stoi(a.substr(x + 1));
+            if (tlbSets <= 0 || (tlbSets & (tlbSets - 1)) || tlbWays <= 0) {
+                cerr << "--tlb takes SETSxWAYS with a power-of-two number of sets\n";
+                return 1;
+            }
+        } else if (a == "--tlb-policy=lru") tlbPolicy = TagCache::LRU;
+        else if (a == "--tlb-policy=fifo") tlbPolicy = TagCache::FIFO;
+        else if (a == "--tlb-policy=random") tlbPolicy = TagCache::RANDOM;
+        else if (a.rfind("--pwc=", 0) == 0) pwcEntries = stoi(a.substr(6));
+        else if (a.rfind("--readahead=", 0) == 0) {
+            // MIN,MAX pages
+            size_t comma = a.find(',', 12);
+            minWindow = stoi(a.substr(12, comma - 12));
+            maxWindow = comma == string::npos ? minWindow : stoi(a.substr(comma + 1));
+            if (minWindow <= 0 || maxWindow < minWindow) {
+                cerr << "--readahead takes MIN,MAX pages with 0 < MIN <= MAX\n";
+                return 1;
+            }
+        } else if (a.rfind("--degree=", 0) == 0) degree = stoi(a.substr(9));
+        else if (a.rfind("--markov=", 0) == 0) markovEntries = stoi(a.substr(9));
+        else if (a.rfind("--points=", 0) == 0) points = stoi(a.substr(9));
+        else if (a.rfind("--shards=", 0) == 0) shardsRate = stod(a.substr(9));
+        else if (a.rfind("--shards-size=", 0) == 0) shardsSize = stoi(a.substr(14));
+        else if (a.rfind("--read-us=", 0) == 0) io.readSeconds = stod(a.substr(10)) * 1e-6;
+        else if (a.rfind("--write-us=", 0) == 0) io.writeSeconds = stod(a.substr(11)) * 1e-6;
+        else if (a == "--addr" || a == "--addr=lackey") addr = true;
+        else if (a == "--addr=binary") addr = addrBinary = true;
+        else if (a.rfind("--page=", 0) == 0) {
+            if ((pageShift = pageShiftOf(a.substr(7))) < 0) {
+                cerr << "page size must be a power of two, e.g. 4K, 2M or 1G\n";
+                return 1;
+            }
+        } else if (a.rfind("--streams=", 0) == 0) {
+            streams = 0;
+            for (char c : a.substr(10))
+                streams |= c == 'I' ? STREAM_I : c == 'L' ? STREAM_L : c == 'S' ? STREAM_S : 0;
+        } else args.push_back(a);
+    }
 
-    fifo(pages, capacity);
-    lru(pages, capacity);
-    optimal(pages, capacity);
+    if (mode == "convert" && args.size() == 2) {
+        uint16_t flags = (wide ? TRACE_WIDE : 0) | (varint ? TRACE_VARINT : 0) | (writes ? TRACE_WRITES : 0);
+        if (!writeTrace(args[1], TextPages{args[0]}, flags)) {
+            cerr << "conversion to " << args[1] << " failed\n";
+            return 1;
+        }
+        TraceReader check(args[1]);
+        cout << "Wrote " << check.size() << " references to " << args[1] << "\n";
+        return 0;
+    }
+    if (mode == "ingest" && args.size() == 2) {
+        // One pass per stream over the mapped file; varint keeps the large
+        // page numbers of 64-bit address spaces compact
+        uint16_t flags = (wide ? TRACE_WIDE : TRACE_VARINT) | TRACE_WRITES;
+        pair<const char *, uint8_t> outputs[] = {
+            {"i", STREAM_I}, {"l", STREAM_L}, {"s", STREAM_S}, {"all", STREAM_I | STREAM_L | STREAM_S}};
+        for (auto [name, sel] : outputs) {
+            AddressPages pages(args[0], addrBinary, pageShift, sel);
+            if (!pages.ok()) {
+                cerr << pages.error() << "\n";
+                return 1;
+            }
+            string out = args[1] + "." + name + ".pgt";
+            if (!writeTrace(out, WithWrites<AddressPages>{pages}, flags)) {
+                cerr << "conversion to " << out << " failed\n";
+                return 1;
+            }
+            TraceReader check(out);
+            cout << "Wrote " << check.size() << " references to " << out << "\n";
+        }
+        return 0;
+    }
+    if (mode == "multi" && args.size() >= 2) {
+        // One trace per process, all streamed side by side
+        int capacity = stoi(args[0]), k = args.size() - 1;
+        if (k > 256 || capacity < k) {
+            cerr << "multi takes 1-256 traces and at least one frame per process\n";
+            return 1;
+        }
+        auto run = [&](auto &owned) -> int {
+            vector<const typename decay_t<decltype(owned)>::value_type::element_type *> traces;
+            for (auto &t : owned) {
+                if (!t->ok()) {
+                    cerr << t->error() << "\n";
+                    return 1;
+                }
+                traces.push_back(t.get());
+            }
+            multiReport(traces, capacity, quantum, window, thrash);
+            return 0;
+        };
+        if (addr) {
+            vector<unique_ptr<AddressPages>> owned;
+            for (int p = 1; p <= k; p++) owned.push_back(make_unique<AddressPages>(args[p], addrBinary, pageShift, streams));
+            return run(owned);
+        }
+        vector<unique_ptr<TraceReader>> owned;
+        for (int p = 1; p <= k; p++) {
+            owned.push_back(make_unique<TraceReader>(args[p], stream));
+            // The merge spaces each process's references by its length up front
+            if (owned.back()->ok() && !owned.back()->seekable()) {
+                cerr << args[p] << " is not seekable: multi needs each trace's length up front; "
+                     << "save it to a file first\n";
+                return 1;
+            }
+        }
+        return run(owned);
+    }
+    bool shards = shardsRate != 0 || shardsSize != 0;
+    if (((mode == "run" || mode == "compare" || mode == "sweep" || mode == "dirty" || mode == "ws" ||
+          mode == "tlb" || mode == "prefetch") &&
+         args.size() == 2) ||
+        (mode == "mrc" && !args.empty()) || (mode == "analyze" && args.size() == 1)) {
+        // The same modes run on a .pgt file or straight off an address trace
+        auto simulateTrace = [&](const auto &trace) -> int {
+            if (mode == "mrc" && shards) {
+                if (args.size() < 2 || stoi(args[1]) < 1 || shardsRate < 0 || shardsRate > 1 || shardsSize < 0) {
+                    cerr << "mrc TRACE MAX_FRAMES --shards=RATE [--shards-size=N]: MAX_FRAMES >= 1, "
+                         << "0 < RATE <= 1, N >= 1\n";
+                    return 1;
+                }
+                // Fixed size without a rate starts at 10%, as in the demo
+                shardsMrc(trace, stoi(args[1]), shardsRate > 0 ? shardsRate : 0.1, shardsSize);
+                return 0;
+            }
+            if (mode == "mrc") {
+                mrc(trace, args.size() > 1 ? stoi(args[1]) : 0);
+                return 0;
+            }
+            if (mode == "analyze") {
+                printProfile(profileTrace(trace, points));
+                return 0;
+            }
+            for (auto &p : policies)
+                if (find(SWEEP_POLICIES.begin(), SWEEP_POLICIES.end(), p) == SWEEP_POLICIES.end()) {
+                    cerr << "unknown policy " << p << "\n";
+                    return 1;
+                }
+            if (mode != "ws" && mode != "sweep" && stoi(args[1]) < 1) {
+                cerr << mode << " TRACE FRAMES: FRAMES must be at least 1\n";
+                return 1;
+            }
+            if (mode == "tlb" || mode == "prefetch") {
+                // Both need the victim's frame slot, which these engines report
+                vector<string> engines;
+                for (auto &p : policies)
+                    if (p == "fifo" || p == "lru" || p == "clock") engines.push_back(p);
+                if (engines.empty() || (engines.size() != policies.size() && policies != SWEEP_POLICIES)) {
+                    cerr << mode << " runs the fifo, lru and clock policies\n";
+                    return 1;
+                }
+                if (mode == "tlb")
+                    translationReport(trace, stoi(args[1]), engines, tlbSets, tlbWays, tlbPolicy, pwcEntries);
+                else
+                    prefetchReport(trace, stoi(args[1]), engines, minWindow, maxWindow, degree, markovEntries);
+                return 0;
+            }
+            if (mode == "ws") {
+                vector<int> taus, thresholds;
+                for (auto &x : split(args[1])) taus.push_back(stoi(x));
+                for (auto &x : split(pffList)) thresholds.push_back(stoi(x));
+                for (int v : taus)
+                    if (v < 1) {
+                        cerr << "ws: every TAU must be at least 1, got " << v << "\n";
+                        return 1;
+                    }
+                for (int v : thresholds)
+                    if (v < 1) {
+                        cerr << "ws: every --pff threshold must be at least 1, got " << v << "\n";
+                        return 1;
+                    }
+                allocationReport(trace, taus, thresholds, maxFrames);
+                return 0;
+            }
+            if (mode == "sweep") {
+                vector<int> capacities;
+                for (auto &c : split(args[1])) {
+                    capacities.push_back(stoi(c));
+                    if (capacities.back() < 1) {
+                        cerr << "sweep: every capacity must be at least 1, got " << c << "\n";
+                        return 1;
+                    }
+                }
+                printSweep(sweep(trace, policies, capacities, threads), trace.size(), json);
+                return 0;
+            }
+            int capacity = stoi(args[1]);
+            if (mode == "dirty") {
+                dirtyReport(WithWrites<decay_t<decltype(trace)>>{trace}, capacity, io);
+                return 0;
+            }
+            if (mode == "compare") {
+                cout << "Policy\t\tFaults\t\tMiss ratio\tSeconds\n";
+                auto run = [&](const string &name, auto frames) {
+                    auto start = chrono::steady_clock::now();
+                    long long faults = countFaults(frames, trace);
+                    double sec = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                    cout << name << "\t" << faults << "\t\t" << (double)faults / trace.size() << "\t" << sec << "\n";
+                };
+                run("LRU\t", LruFrames(capacity));
+                run("CLOCK\t", ClockFrames(capacity));
+                run("Second Chance", SecondChanceFrames(capacity));
+                run("GCLOCK\t", GClockFrames(capacity));
+                run("ARC\t", ArcFrames(capacity));
+                run("2Q\t", TwoQFrames(capacity));
+                run("CAR\t", CarFrames(capacity));
+                run("LIRS\t", LirsFrames(capacity));
+                run("W-TinyLFU", TinyLfuFrames(capacity));
+                return 0;
+            }
+            vector<long long> next;
+            if (find(policies.begin(), policies.end(), "opt") != policies.end()) next = nextUses(trace);
+            for (auto &policy : policies) {
+                if (debug) {
+                    policyFaults(policy, trace, capacity, next, TextSink());
+                } else if (!eventsPrefix.empty()) {
+                    EventLogSink log(eventsPrefix + policy + ".pgev");
+                    if (!log.ok()) {
+                        cerr << "cannot write " << eventsPrefix + policy + ".pgev\n";
+                        return 1;
+                    }
+                    long long faults = policyFaults(policy, trace, capacity, next, log);
+                    cout << policy << ": " << faults << " faults, events in " << eventsPrefix + policy + ".pgev\n";
+                } else {
+                    long long faults = policyFaults(policy, trace, capacity, next);
+                    cout << policy << ": " << faults << " faults, hit ratio "
+                         << 1 - (double)faults / max<long long>(trace.size(), 1) << "\n";
+                }
+            }
+            return 0;
+        };
+        if (addr) {
+            AddressPages trace(args[0], addrBinary, pageShift, streams);
+            if (!trace.ok()) {
+                cerr << trace.error() << "\n";
+                return 1;
+            }
+            return simulateTrace(trace);
+        }
+        TraceReader trace(args[0], stream);
+        if (!trace.ok()) {
+            cerr << trace.error() << "\n";
+            return 1;
+        }
+        // A pipe can be read once: only one policy, and not opt (next-use
+        // pass first), analyze, or mrc with SHARDS
+        bool onePass = (mode == "run" && policies.size() == 1 && policies[0] != "opt") || mode == "analyze" ||
+                       (mode == "mrc" && shards);
+        if (!trace.seekable() && !onePass) {
+            cerr << args[0] << " is not seekable and " << mode << (mode == "run" ? " with these policies" : "")
+                 << " reads the trace more than once: save it to a file first"
+                 << (mode == "run" ? ", or run one policy other than opt" : "") << "\n";
+            return 1;
+        }
+        if (mode == "dirty" && !trace.hasWrites())
+            cerr << args[0] << " has no write flags (convert with --writes): every page stays clean\n";
+        return simulateTrace(trace);
+    }
 
-    return 0;
+    cerr << "usage: " << argv[0] << " [convert TEXT OUT.pgt [--64] [--varint] [--writes] | "
+         << "run TRACE.pgt FRAMES [--policies=P,...] [--stream] [--debug | --events=PREFIX] | mrc TRACE.pgt [MAX_FRAMES] [--stream] | "
+         << "mrc TRACE.pgt MAX_FRAMES --shards=RATE [--shards-size=N] [--stream] | "
+         << "compare TRACE.pgt FRAMES [--stream] | "
+         << "sweep TRACE.pgt FRAMES[,FRAMES...] [--policies=P,...] [--threads=N] [--json] [--stream] | "
+         << "ingest ADDRS OUT [--addr=binary] [--page=SIZE] [--64] | "
+         << "dirty TRACE.pgt FRAMES [--read-us=N] [--write-us=N] [--stream] | "
+         << "ws TRACE.pgt TAU[,TAU...] [--pff=T,...] [--max-frames=N] [--stream] | "
+         << "multi FRAMES TRACE.pgt... [--quantum=N] [--window=N] [--thrash=R] [--stream] | "
+         << "tlb TRACE.pgt FRAMES [--tlb=SETSxWAYS] [--tlb-policy=lru|fifo|random] [--pwc=N] [--policies=P,...] [--stream] | "
+         << "prefetch TRACE.pgt FRAMES [--readahead=MIN,MAX] [--degree=N] [--markov=N] [--policies=P,...] [--stream] | "
+         << "analyze TRACE.pgt [--points=N] [--stream]]\n"
+         << "run/mrc/compare/sweep/dirty/ws/multi/tlb/prefetch/analyze take an address trace with --addr[=lackey|binary] [--page=SIZE] [--streams=ILS]\n";
+    return 1;
 }
 /*
-Sure 👍 — here’s a **complete C++ program** that simulates the three main **Page Replacement Algorithms** used in operating systems:
+EXPLANATION
+Here’s a **short code summary** of the page replacement simulator 👇
 
-👉 **FIFO**, **LRU**, and **Optimal**.
+---
+
+### 💻 **Code Summary**
+
+* Page numbers are 64-bit (`Page`). Every simulation takes its reference string as any iterable range: a `vector<int>` literal, a `.pgt` trace file (`TraceReader`), a text page list (`TextPages`) or a raw address trace (`AddressPages`).
+* Each policy is a **frames engine** driven by one loop, `simulate()`, which reports every reference to a **sink**: `CountSink` only counts faults, `TextSink` prints each step (the original output), `EventLogSink` writes a binary `.pgev` event log.
+* LRU, FIFO, CLOCK and ARC run on the header-only library `cache.h` (`cachelib::Cache<Key, Value, Policy>`), which also provides `ConcurrentClockCache`, a sharded CLOCK cache with lock-free reads.
+* Policies: `fifo()`, `lru()`, `mru()`, `clockReplacement()`, `secondChance()`, `gclock()`, `arc()`, `twoQ()`, `car()`, `lirs()`, `tinyLfu()` (W-TinyLFU with a count-min sketch) and `optimal()` (Belady, using a next-use pass over the trace). `engineParity()` checks the LRU and OPT engines against plain array scans.
+* `mrc()` → Exact **LRU miss-ratio curve** for every frame count in one pass (stack distances with a Fenwick tree). `shardsMissRatio()` → **SHARDS** sampled curve in bounded memory, with an error estimate from the spread over several hash seeds.
+* `dirtyReport()` → **Write-back** model: clean vs dirty evictions and I/O time, including the enhanced (referenced, modified) CLOCK.
+* `allocationReport()` → **Working set** WS(tau) and **page-fault frequency** allocation against fixed LRU frames.
+* `multiReport()` → Several processes sharing memory: global vs local LRU/CLOCK replacement, per-process faults and thrashing.
+* `translationReport()` → **TLB** (set-associative, LRU/FIFO/random), page-walk cache and a 4-level page table in front of the frames.
+* `prefetchReport()` → **Readahead**, **stride** and **Markov** prefetchers: useful vs wasted prefetches.
+* `profileTrace()` → Reuse-distance and inter-reference gap histograms, footprint and one-hit wonders (JSON).
+* `main()` with no arguments runs the built-in example: every policy on the same 13-reference string with 3 frames, then short demos of the reports above. With arguments it is a command-line tool: `convert` / `ingest` build `.pgt` traces (fixed 32/64-bit or varint, optional write flags), and `run`, `mrc`, `compare`, `sweep`, `dirty`, `ws`, `multi`, `tlb`, `prefetch` and `analyze` run on them. Traces can be streamed (`--stream`) or memory-mapped. Single-pass modes also read from a pipe. See the comment above `main()` for every option.
 
 ---
 
@@ -139,19 +3251,14 @@ When a process needs a page that’s not in memory (a **page fault**), the OS mu
 | ----------------------------- | -------------------------------------------------------------------------- |
 | **FIFO (First In First Out)** | Replace the page that entered memory first.                                |
 | **LRU (Least Recently Used)** | Replace the page that has not been used for the longest time.              |
+| **MRU (Most Recently Used)**  | Replace the page used last; good for repeated scans.                       |
+| **CLOCK / Second Chance**     | Approximate LRU with a reference bit and a rotating hand.                  |
+| **GCLOCK**                    | CLOCK with a reference counter instead of a bit.                           |
+| **ARC / CAR**                 | Balance recency and frequency lists, adapting their sizes to ghost hits.   |
+| **2Q**                        | Admit new pages to a FIFO; promote them only when referenced again.        |
+| **LIRS**                      | Keep pages with short inter-reference recency; evict the rest first.       |
+| **W-TinyLFU**                 | Admit a page only if it is more frequent than the victim (sketch counts).  |
 | **Optimal**                   | Replace the page that will not be used for the longest time in the future. |
 
----
-
-## ✍️ Short Explanation
-
-This program simulates three page replacement algorithms (FIFO, LRU, Optimal).
-It uses a predefined sequence of page references and a fixed number of memory frames (3).
-Each algorithm tracks **page faults** and replaces pages according to its strategy:
-
-* **FIFO** removes the oldest loaded page.
-* **LRU** removes the least recently used page.
-* **Optimal** removes the page that will not be used for the longest time in the future.
-
-At the end, the total number of **page faults** is displayed for performance comparison.
+The total number of **page faults** per algorithm is displayed for performance comparison.
 */
@@ -5,8 +5,13 @@
 #include <bits/stdc++.h>
 using namespace std;
 
+const int MAX_CPUS = 256;
+using CpuMask = bitset<MAX_CPUS>;   // bit c = may run on CPU c
+
 struct Process {
     int pid, at, bt, prio, ct, tat, wt, rt;
+    int threads = 1;                // gang size (threads that must run together)
+    CpuMask affinity = ~CpuMask();  // default: any CPU
 };
 
 // Function to display results
@@ -98,35 +103,40 @@ void prioritySched(vector<Process> p) {
 }
 
 // 4️⃣ Round Robin (Preemptive)
-void roundRobin(vector<Process> p, int q) {
-    int n = p.size(), t = 0;
+// Core loop shared by roundRobin() and the quantum search below. Fills ct and
+// returns each process's first dispatch time. `cs` is the cost of a context
+// switch (0 in the textbook model). Arrivals are admitted in index order,
+// exactly like a full scan, but from a pointer into the arrival-sorted list.
+vector<int> rrSimulate(vector<Process> &p, int q, int cs = 0) {
+    int n = p.size(), t = 0, done = 0, last = -1;
+    vector<int> order(n), rt(n), firstRun(n, -1);
+    for (int i = 0; i < n; i++) rt[i] = p[i].bt, order[i] = i;
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return p[a].at < p[b].at; });
+    int next = 0;
     queue<int> ready;
-    vector<int> rt(n), vis(n, 0);
-    for (int i = 0; i < n; i++) rt[i] = p[i].bt;
-    int done = 0;
-    while (done < n) {
-        for (int i = 0; i < n; i++) {
-            if (!vis[i] && p[i].at <= t) {
-                ready.push(i);
-                vis[i] = 1;
-            }
-        }
+    auto admit = [&] {
+        int from = next;
+        while (next < n && p[order[next]].at <= t) next++;
+        sort(order.begin() + from, order.begin() + next);
+        for (int k = from; k < next; k++) ready.push(order[k]);
+    };
 
+    while (done < n) {
+        admit();
         if (ready.empty()) {
-            t++;
+            t = p[order[next]].at;
             continue;
         }
 
         int i = ready.front();
         ready.pop();
+        if (i != last) t += cs, last = i;
+        if (firstRun[i] < 0) firstRun[i] = t;
         int exec = min(q, rt[i]);
         rt[i] -= exec;
         t += exec;
 
-        for (int j = 0; j < n; j++) {
-            if (!vis[j] && p[j].at <= t)
-                ready.push(j), vis[j] = 1;
-        }
+        admit();
 
         if (rt[i] == 0) {
             p[i].ct = t;
@@ -134,13 +144,610 @@ void roundRobin(vector<Process> p, int q) {
         } else
             ready.push(i);
     }
+    return firstRun;
+}
 
+void roundRobin(vector<Process> p, int q) {
+    rrSimulate(p, q);
     cout << "\n=== Round Robin Scheduling ===\n";
     display(p);
 }
 
+// Round Robin quantum search
+// Coarse sweep over [1, qMax] on all host threads, then golden-section
+// refinement around the best grid point. Every simulated quantum is memoized,
+// and the memo is returned as the objective curve. The refinement assumes the
+// objective is unimodal near the coarse optimum.
+enum RRObjective { MEAN_WT, P99_RESPONSE, THROUGHPUT };
+
+struct QuantumSearch {
+    int best;
+    double bestValue;
+    vector<pair<int, double>> curve;   // (quantum, objective), sorted by quantum
+};
+
+double rrObjective(vector<Process> p, int q, RRObjective obj, int cs) {
+    vector<int> firstRun = rrSimulate(p, q, cs);
+    int n = p.size();
+    if (obj == MEAN_WT) {
+        double wt = 0;
+        for (auto &x : p) wt += x.ct - x.at - x.bt;
+        return wt / n;
+    }
+    if (obj == P99_RESPONSE) {
+        vector<int> resp(n);
+        for (int i = 0; i < n; i++) resp[i] = firstRun[i] - p[i].at;
+        int k = max(0, (int)ceil(0.99 * n) - 1);
+        nth_element(resp.begin(), resp.begin() + k, resp.end());
+        return resp[k];
+    }
+    int makespan = 0;
+    for (auto &x : p) makespan = max(makespan, x.ct);
+    return (double)n / makespan;          // processes per time unit
+}
+
+QuantumSearch optimizeQuantum(const vector<Process> &p, RRObjective obj, int cs = 0,
+                              int qMax = 0, int coarse = 16) {
+    if (qMax <= 0)
+        for (auto &x : p) qMax = max(qMax, x.bt);
+    // Lower cost is better; throughput is maximized
+    auto cost = [&](double v) { return obj == THROUGHPUT ? -v : v; };
+
+    map<int, double> memo;
+    mutex memoLock;
+    auto eval = [&](int q) {
+        {
+            lock_guard<mutex> lk(memoLock);
+            auto it = memo.find(q);
+            if (it != memo.end()) return it->second;
+        }
+        double v = rrObjective(p, q, obj, cs);
+        lock_guard<mutex> lk(memoLock);
+        return memo[q] = v;
+    };
+
+    // 1. Coarse parallel sweep
+    vector<int> grid;
+    for (int k = 0; k < coarse; k++) {
+        int q = 1 + (int)((long long)(qMax - 1) * k / max(1, coarse - 1));
+        if (grid.empty() || grid.back() != q) grid.push_back(q);
+    }
+    atomic<int> nextJob{0};
+    auto sweep = [&] {
+        for (int k; (k = nextJob++) < (int)grid.size();) eval(grid[k]);
+    };
+    int threads = min((int)grid.size(), (int)max(1u, thread::hardware_concurrency()));
+    vector<thread> pool;
+    for (int i = 1; i < threads; i++) pool.emplace_back(sweep);
+    sweep();
+    for (auto &t : pool) t.join();
+
+    int k = 0;
+    for (int i = 1; i < (int)grid.size(); i++)
+        if (cost(eval(grid[i])) < cost(eval(grid[k]))) k = i;
+
+    // 2. Golden-section refinement on the integers between the neighbours
+    const double invPhi = (sqrt(5.0) - 1) / 2;
+    int a = grid[max(0, k - 1)], b = grid[min((int)grid.size() - 1, k + 1)];
+    while (b - a > 3) {
+        int c = b - (int)round((b - a) * invPhi), d = a + (int)round((b - a) * invPhi);
+        if (cost(eval(c)) <= cost(eval(d)))
+            b = d;
+        else
+            a = c;
+    }
+    for (int q = a; q <= b; q++) eval(q);
+
+    QuantumSearch res{grid[k], eval(grid[k]), {memo.begin(), memo.end()}};
+    for (auto &[q, v] : res.curve)
+        if (cost(v) < cost(res.bestValue)) res.best = q, res.bestValue = v;
+    return res;
+}
+
+// Gang scheduling (coscheduled time slices) with CPU affinity
+// All threads of a job run together or not at all. At every slice boundary
+// the ready gangs are placed in queue order onto free CPUs inside their
+// affinity mask (lowest CPUs first); gangs that do not fit wait. Placed gangs
+// run one quantum and rejoin the back of the queue, so waiting gangs keep
+// their place in front. Fragmentation is the share of core-time left idle
+// while at least one gang was waiting.
+struct GangResult {
+    double fragmentation = 0, meanSlowdown = 0, maxSlowdown = 0;
+    int unschedulable = 0;          // gang larger than its affinity mask
+};
+
+GangResult gangSchedule(vector<Process> &p, int cpus, int quantum) {
+    int n = p.size();
+    CpuMask all;
+    for (int c = 0; c < cpus && c < MAX_CPUS; c++) all[c] = 1;
+
+    GangResult r;
+    vector<int> order, rt(n);
+    for (int i = 0; i < n; i++) {
+        rt[i] = p[i].bt;
+        p[i].ct = -1;
+        if ((int)(p[i].affinity & all).count() >= p[i].threads)
+            order.push_back(i);
+        else
+            r.unschedulable++;
+    }
+    stable_sort(order.begin(), order.end(), [&](int a, int b) { return p[a].at < p[b].at; });
+
+    deque<int> ready, placed;
+    size_t next = 0;
+    long long t = 0, done = 0, fragmented = 0;
+    while (done < (long long)order.size()) {
+        while (next < order.size() && p[order[next]].at <= t) ready.push_back(order[next++]);
+        if (ready.empty()) {
+            t = p[order[next]].at;
+            continue;
+        }
+
+        CpuMask free = all;
+        deque<int> waiting;
+        for (int i : ready) {
+            CpuMask avail = free & p[i].affinity;
+            if ((int)avail.count() < p[i].threads) {
+                waiting.push_back(i);
+                continue;
+            }
+            size_t c = avail._Find_first();
+            for (int k = 0; k < p[i].threads; k++, c = avail._Find_next(c)) free[c] = 0;
+            placed.push_back(i);
+        }
+
+        int slice = quantum;
+        bool gangsWaiting = !waiting.empty();
+        if (gangsWaiting)
+            fragmented += (long long)free.count() * slice;
+        else
+            for (int i : placed) slice = min(slice, rt[i]);  // nobody waits: stop at first completion
+        for (int i : placed) {
+            int exec = min(slice, rt[i]);
+            rt[i] -= exec;
+            // A gang that finishes early leaves its cores idle for the rest of the slice
+            if (gangsWaiting) fragmented += (long long)p[i].threads * (slice - exec);
+            if (rt[i] == 0) {
+                p[i].ct = t + exec;
+                done++;
+            } else
+                waiting.push_back(i);
+        }
+        placed.clear();
+        ready.swap(waiting);
+        t += slice;
+    }
+
+    long long makespan = max(1LL, t);
+    r.fragmentation = (double)fragmented / ((double)cpus * makespan);
+    for (int i : order) {
+        double slowdown = (double)(p[i].ct - p[i].at) / max(1, p[i].bt);
+        r.meanSlowdown += slowdown;
+        r.maxSlowdown = max(r.maxSlowdown, slowdown);
+    }
+    r.meanSlowdown /= max<size_t>(1, order.size());
+    return r;
+}
+
+// Averages only (for workloads too large to print row by row). Jobs that
+// never ran (ct < 0, e.g. a gang wider than its affinity mask) are left out
+// of the averages and counted separately.
+void summary(vector<Process> &p, const string &name) {
+    double avgTAT = 0, avgWT = 0;
+    long long makespan = 0, ran = 0;
+    for (auto &x : p) {
+        if (x.ct < 0) continue;
+        x.tat = x.ct - x.at;
+        x.wt = x.tat - x.bt;
+        avgTAT += x.tat;
+        avgWT += x.wt;
+        makespan = max(makespan, (long long)x.ct);
+        ran++;
+    }
+    cout << name << ": Average TAT: " << avgTAT / max(ran, 1LL)
+         << "  Average WT: " << avgWT / max(ran, 1LL)
+         << "  Makespan: " << makespan;
+    if (ran < (long long)p.size()) cout << "  Unschedulable: " << p.size() - ran;
+    cout << "\n";
+}
+
+// Random workload generator (fixed seed => same workload every run)
+vector<Process> randomWorkload(int n, int arrivalSpan, int maxBurst, unsigned seed) {
+    mt19937 rng(seed);
+    vector<Process> p(n);
+    for (int i = 0; i < n; i++) {
+        p[i] = {i + 1, (int)(rng() % (arrivalSpan + 1)),
+                (int)(rng() % maxBurst) + 1, (int)(rng() % 8)};
+    }
+    return p;
+}
+
+// 5️⃣ Multi-CPU Round Robin (cluster what-if)
+// Every CPU runs its own RR ready queue; job j arrives on CPU j % cpus.
+// When a CPU's ready queue grows past `migrateAbove` at the end of a slice,
+// it hands its newest job to the next CPU, which sees it `migrateDelay`
+// time units later. That delay is the lookahead of the parallel mode:
+// nothing sent inside a window [T, T + delay) can land before the window ends.
+// DVFS: each CPU runs at one of `levels` (slowest first) and picks its level
+// at every dispatch. Burst times are work at the top frequency, so a slice at
+// f MHz does quantum * f / fmax units of work. Power is per level; an idle
+// CPU draws idleWatts until the makespan. With no levels the model is plain RR.
+struct FreqLevel {
+    int mhz;
+    double activeWatts;
+};
+
+// P(f) = staticWatts + dynamicWatts * (f / fmax)^3, the usual CMOS curve
+vector<FreqLevel> cubicPowerCurve(const vector<int> &mhz, double staticWatts, double dynamicWatts) {
+    vector<FreqLevel> levels;
+    double fmax = *max_element(mhz.begin(), mhz.end());
+    for (int f : mhz) levels.push_back({f, staticWatts + dynamicWatts * pow(f / fmax, 3)});
+    sort(levels.begin(), levels.end(), [](auto &a, auto &b) { return a.mhz < b.mhz; });
+    return levels;
+}
+
+enum DvfsPolicy {
+    RACE_TO_IDLE,        // always top frequency, then sleep
+    STRETCH_TO_DEADLINE  // slowest level projected to meet the deadline (best effort:
+                         // the projection only sees the local queue)
+};
+
+struct ClusterConfig {
+    int cpus = 4;
+    int quantum = 2;
+    int migrateAbove = 4;        // ready-queue length that triggers migration
+    long long migrateDelay = 8;  // migration latency == lookahead window; must be
+                                 // >= 1 or no window could advance (< 1 runs as 1)
+    int threads = 1;             // host threads (0 = hardware concurrency)
+    vector<FreqLevel> levels;    // empty = no DVFS, slices run at full speed
+    double idleWatts = 0;
+    DvfsPolicy dvfs = RACE_TO_IDLE;
+    double deadlineSlack = 0;    // deadline = AT + slack * BT (0 = no deadlines)
+};
+
+struct ClusterResult {
+    vector<long long> ct;        // completion time, indexed like the input
+    long long migrations = 0, events = 0, deadlineMisses = 0;
+    double energy = 0;           // watts x time units, idle time included
+};
+
+struct ClusterEvent {
+    long long t;
+    int cpu, kind, job, rem;     // kind 0 = slice end, 1 = arrival/migration
+    // Total order on (t, cpu, kind, job): every run pops the same sequence
+    bool operator>(const ClusterEvent &o) const {
+        return tie(t, cpu, kind, job) > tie(o.t, o.cpu, o.kind, o.job);
+    }
+};
+using ClusterQueue = priority_queue<ClusterEvent, vector<ClusterEvent>, greater<ClusterEvent>>;
+
+struct ClusterCpu {
+    deque<pair<int, int>> ready; // (job, remaining burst)
+    int running = -1, runRem = 0, runExec = 0;
+    long long busy = 0;          // time spent running
+    double activeEnergy = 0;
+};
+
+// Counters owned by one host thread
+struct ClusterCounters {
+    long long migrations = 0, events = 0, deadlineMisses = 0;
+};
+
+// Affinity in the cluster model: masks cover CPUs 0..MAX_CPUS-1, CPUs beyond
+// that are always allowed. Arrivals go to the first allowed CPU at or after
+// j % cpus; migrations to the next allowed CPU (-1 if there is none).
+bool clusterAllowed(const Process &x, int c) {
+    return c >= MAX_CPUS || x.affinity[c];
+}
+int clusterHome(const Process &x, int j, const ClusterConfig &cfg) {
+    int c = j % cfg.cpus;
+    for (int k = 0; k < cfg.cpus && !clusterAllowed(x, c); k++) c = (c + 1) % cfg.cpus;
+    return c;
+}
+int clusterNext(const Process &x, int from, const ClusterConfig &cfg) {
+    for (int k = 1, c = (from + 1) % cfg.cpus; k < cfg.cpus; k++, c = (c + 1) % cfg.cpus)
+        if (clusterAllowed(x, c)) return c;
+    return -1;
+}
+
+// A zero-length lookahead would stall the parallel run, so both runs clamp
+long long clusterDelay(const ClusterConfig &cfg) { return max(1LL, cfg.migrateDelay); }
+
+long long clusterDeadline(const Process &x, const ClusterConfig &cfg) {
+    return x.at + (long long)ceil(cfg.deadlineSlack * x.bt);
+}
+
+// One event on one CPU. Only touches that CPU's state; anything for another
+// CPU leaves through `send`, so CPUs never share state inside a window.
+template <class Push, class Send>
+void clusterStep(const ClusterEvent &e, ClusterCpu &c, const ClusterConfig &cfg,
+                 const vector<Process> &p, vector<long long> &ct, ClusterCounters &n,
+                 Push push, Send send) {
+    if (e.kind == 1) {
+        c.ready.push_back({e.job, e.rem});
+    } else {
+        c.runRem -= c.runExec;
+        if (c.runRem == 0) {
+            ct[c.running] = e.t;
+            if (cfg.deadlineSlack > 0 && e.t > clusterDeadline(p[c.running], cfg))
+                n.deadlineMisses++;
+        } else
+            c.ready.push_back({c.running, c.runRem});
+        c.running = -1;
+        while ((int)c.ready.size() > cfg.migrateAbove) {
+            auto [job, rem] = c.ready.back();
+            int to = clusterNext(p[job], e.cpu, cfg);
+            if (to < 0) break;
+            c.ready.pop_back();
+            send({e.t + clusterDelay(cfg), to, 1, job, rem});
+            n.migrations++;
+        }
+    }
+    if (c.running == -1 && !c.ready.empty()) {
+        tie(c.running, c.runRem) = c.ready.front();
+        c.ready.pop_front();
+        long long wall = min(cfg.quantum, c.runRem);
+        c.runExec = wall;
+        if (!cfg.levels.empty()) {
+            long long fmax = cfg.levels.back().mhz;
+            const FreqLevel *lv = &cfg.levels.back();
+            if (cfg.dvfs == STRETCH_TO_DEADLINE) {
+                // Under RR the job shares the CPU with everything queued behind it.
+                // Later arrivals and migrations also take turns, so keep one quantum
+                // per sharer of headroom; the level is re-picked at every dispatch.
+                long long deadline = clusterDeadline(p[c.running], cfg), share = c.ready.size() + 1;
+                for (auto &l : cfg.levels)
+                    if (e.t + share * ((c.runRem * fmax + l.mhz - 1) / l.mhz + cfg.quantum) <= deadline) {
+                        lv = &l;
+                        break;
+                    }
+            }
+            long long need = (c.runRem * fmax + lv->mhz - 1) / lv->mhz;
+            wall = min<long long>(cfg.quantum, need);
+            c.runExec = wall == need ? c.runRem : max(1LL, wall * lv->mhz / fmax);
+            c.activeEnergy += lv->activeWatts * wall;
+        }
+        c.busy += wall;
+        push({e.t + wall, e.cpu, 0, c.running, 0});
+    }
+}
+
+// Idle energy is charged up to the makespan; CPUs are summed in index order so
+// the floating-point total does not depend on how the run was partitioned.
+void clusterEnergy(ClusterResult &r, const vector<ClusterCpu> &cpu, const ClusterConfig &cfg) {
+    long long makespan = r.ct.empty() ? 0 : *max_element(r.ct.begin(), r.ct.end());
+    for (auto &c : cpu)
+        r.energy += c.activeEnergy + cfg.idleWatts * (makespan - c.busy);
+}
+
+// Reference run: one global event queue, migrations scheduled directly
+ClusterResult clusterSequential(const vector<Process> &p, const ClusterConfig &cfg) {
+    ClusterResult r;
+    r.ct.assign(p.size(), 0);
+    vector<ClusterCpu> cpu(cfg.cpus);
+    ClusterQueue pq;
+    for (int j = 0; j < (int)p.size(); j++)
+        pq.push({p[j].at, clusterHome(p[j], j, cfg), 1, j, p[j].bt});
+
+    ClusterCounters n;
+    auto push = [&](const ClusterEvent &e) { pq.push(e); };
+    while (!pq.empty()) {
+        ClusterEvent e = pq.top();
+        pq.pop();
+        n.events++;
+        clusterStep(e, cpu[e.cpu], cfg, p, r.ct, n, push, push);
+    }
+    r.migrations = n.migrations;
+    r.events = n.events;
+    r.deadlineMisses = n.deadlineMisses;
+    clusterEnergy(r, cpu, cfg);
+    return r;
+}
+
+// Lock-free multi-producer mailbox (Treiber stack). Producers post during a
+// window; the owning group drains it after the barrier. Drain order does not
+// matter because events go straight into the owner's ordered queue.
+struct Mailbox {
+    struct Node { ClusterEvent e; Node *next; };
+    atomic<Node *> head{nullptr};
+
+    void post(const ClusterEvent &e) {
+        Node *n = new Node{e, head.load(memory_order_relaxed)};
+        while (!head.compare_exchange_weak(n->next, n, memory_order_release,
+                                           memory_order_relaxed)) {}
+    }
+    template <class F> void drain(F f) {
+        Node *n = head.exchange(nullptr, memory_order_acquire);
+        while (n) {
+            f(n->e);
+            Node *next = n->next;
+            delete n;
+            n = next;
+        }
+    }
+};
+
+// Reusable thread barrier
+struct Barrier {
+    mutex m;
+    condition_variable cv;
+    int n, waiting = 0, gen = 0;
+    explicit Barrier(int n) : n(n) {}
+    void wait() {
+        unique_lock<mutex> lk(m);
+        int g = gen;
+        if (++waiting == n) {
+            waiting = 0;
+            gen++;
+            cv.notify_all();
+        } else {
+            cv.wait(lk, [&] { return g != gen; });
+        }
+    }
+};
+
+// Conservative parallel run: CPUs are split into contiguous groups, one host
+// thread per group. Each window covers [T, T + migrateDelay); migrations go
+// through the destination group's mailbox and are merged at the barrier.
+ClusterResult clusterParallel(const vector<Process> &p, const ClusterConfig &cfg) {
+    int groups = cfg.threads > 0 ? cfg.threads : (int)max(1u, thread::hardware_concurrency());
+    groups = min(groups, cfg.cpus);
+    vector<int> owner(cfg.cpus);
+    for (int c = 0; c < cfg.cpus; c++)
+        owner[c] = (int)((long long)c * groups / cfg.cpus);
+
+    ClusterResult r;
+    r.ct.assign(p.size(), 0);
+    vector<ClusterCpu> cpu(cfg.cpus);
+    vector<ClusterQueue> pq(groups);
+    vector<Mailbox> box(groups);
+    vector<long long> nextT(groups);
+    vector<ClusterCounters> counters(groups);
+    for (int j = 0; j < (int)p.size(); j++) {
+        int c = clusterHome(p[j], j, cfg);
+        pq[owner[c]].push({p[j].at, c, 1, j, p[j].bt});
+    }
+
+    Barrier bar(groups);
+    auto worker = [&](int g) {
+        auto push = [&](const ClusterEvent &e) { pq[g].push(e); };
+        auto send = [&](const ClusterEvent &e) { box[owner[e.cpu]].post(e); };
+        long long T = 0;
+        while (true) {
+            long long end = T + clusterDelay(cfg);
+            while (!pq[g].empty() && pq[g].top().t < end) {
+                ClusterEvent e = pq[g].top();
+                pq[g].pop();
+                counters[g].events++;
+                // Each job lives on one CPU at a time, so ct writes never collide
+                clusterStep(e, cpu[e.cpu], cfg, p, r.ct, counters[g], push, send);
+            }
+            bar.wait();
+            box[g].drain(push);
+            nextT[g] = pq[g].empty() ? LLONG_MAX : pq[g].top().t;
+            bar.wait();
+            long long mn = *min_element(nextT.begin(), nextT.end());
+            if (mn == LLONG_MAX) break;
+            T = max(end, mn);
+        }
+    };
+    vector<thread> pool;
+    for (int g = 1; g < groups; g++) pool.emplace_back(worker, g);
+    worker(0);
+    for (auto &t : pool) t.join();
+    for (auto &n : counters) {
+        r.events += n.events;
+        r.migrations += n.migrations;
+        r.deadlineMisses += n.deadlineMisses;
+    }
+    clusterEnergy(r, cpu, cfg);
+    return r;
+}
+
+// Quantum search demo: best quantum per objective with a context-switch cost
+void quantumDemo() {
+    vector<Process> jobs = randomWorkload(2000, 50000, 40, 7);
+    int cs = 1;
+    const char *names[] = {"Mean WT", "p99 response", "Throughput"};
+    cout << "\n=== Round Robin Quantum Search (" << jobs.size()
+         << " processes, context switch = " << cs << ") ===\n";
+    for (RRObjective obj : {MEAN_WT, P99_RESPONSE, THROUGHPUT}) {
+        QuantumSearch r = optimizeQuantum(jobs, obj, cs);
+        cout << names[obj] << ": best quantum = " << r.best << " (" << r.bestValue
+             << "), " << r.curve.size() << " quanta simulated\n  curve:";
+        for (auto &[q, v] : r.curve) cout << " " << q << "=" << v;
+        cout << "\n";
+    }
+}
+
+// Gang demo: mixed 1..32-thread jobs on 256 cores, some pinned to one socket
+void gangDemo() {
+    vector<Process> jobs = randomWorkload(20000, 25000, 40, 5);
+    mt19937 rng(5);
+    CpuMask socket0;
+    for (int c = 0; c < 128; c++) socket0[c] = 1;
+    for (auto &x : jobs) {
+        x.threads = 1 << (rng() % 6);
+        if (rng() % 4 == 0) x.affinity = socket0;
+    }
+    cout << "\n=== Gang Scheduling (256 CPUs, " << jobs.size() << " jobs) ===\n";
+    for (int q : {4, 16}) {
+        GangResult r = gangSchedule(jobs, 256, q);
+        summary(jobs, "Quantum " + to_string(q));
+        cout << "  Fragmentation: " << 100 * r.fragmentation << "% of core-time idle while gangs waited"
+             << "  Slowdown: mean " << r.meanSlowdown << ", max " << r.maxSlowdown << "\n";
+    }
+}
+
+// Cluster what-if: same workload, sequential vs parallel, results must match.
+// Arrivals are spread so the load per CPU is the same at any size.
+void clusterDemo(int cpus, int n) {
+    ClusterConfig cfg;
+    cfg.cpus = cpus;
+    cfg.quantum = 4;
+    cfg.migrateAbove = 3;
+    cfg.migrateDelay = 16;
+    vector<Process> jobs = randomWorkload(n, (int)((long long)n * 100 / cpus), 60, 42);
+
+    cout << "\n=== Multi-CPU Round Robin (" << cfg.cpus << " CPUs, "
+         << jobs.size() << " jobs) ===\n";
+    auto run = [&](const string &name, auto sim) {
+        auto start = chrono::steady_clock::now();
+        ClusterResult r = sim(jobs, cfg);
+        double ms = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        vector<Process> p = jobs;
+        for (int j = 0; j < (int)p.size(); j++) p[j].ct = r.ct[j];
+        summary(p, name);
+        cout << "  events: " << r.events << "  migrations: " << r.migrations
+             << "  wall: " << ms << " ms\n";
+        return r;
+    };
+    ClusterResult seq = run("Sequential", clusterSequential);
+    cfg.threads = 0;
+    ClusterResult par = run("Parallel  ", clusterParallel);
+    bool same = seq.ct == par.ct && seq.migrations == par.migrations && seq.events == par.events;
+    cout << "Parallel run identical to sequential: " << (same ? "yes" : "NO") << "\n";
+}
+
+// DVFS demo: race-to-idle vs stretch-to-deadline on the same cluster workload
+void dvfsDemo(int cpus, int n) {
+    ClusterConfig cfg;
+    cfg.cpus = cpus;
+    cfg.quantum = 4;
+    cfg.migrateAbove = 3;
+    cfg.migrateDelay = 16;
+    cfg.threads = 0;
+    cfg.levels = cubicPowerCurve({800, 1600, 2400, 3200}, 0.5, 2.0);
+    cfg.idleWatts = 0.3;
+    cfg.deadlineSlack = 4;
+    // Arrivals span 0.4 time units per job at 1,024 CPUs, scaled to keep the load
+    vector<Process> jobs = randomWorkload(n, (int)((long long)n * 2048 / (5 * cpus)), 30, 99);
+
+    cout << "\n=== DVFS on " << cfg.cpus << " CPUs (" << jobs.size() << " jobs, deadline = AT + "
+         << cfg.deadlineSlack << " x BT) ===\n";
+    long long raceMisses = 0;
+    double raceEnergy = 0;
+    for (DvfsPolicy policy : {RACE_TO_IDLE, STRETCH_TO_DEADLINE}) {
+        cfg.dvfs = policy;
+        ClusterResult r = clusterParallel(jobs, cfg);
+        vector<Process> p = jobs;
+        for (int j = 0; j < (int)p.size(); j++) p[j].ct = r.ct[j];
+        summary(p, policy == RACE_TO_IDLE ? "Race-to-idle       " : "Stretch-to-deadline");
+        long long makespan = *max_element(r.ct.begin(), r.ct.end());
+        cout << "  Energy: " << r.energy << "  EDP: " << r.energy * makespan
+             << "  Deadline misses: " << r.deadlineMisses << "\n";
+        if (policy == RACE_TO_IDLE) raceMisses = r.deadlineMisses, raceEnergy = r.energy;
+        else
+            cout << "  Trade-off vs race-to-idle: " << 100 * (1 - r.energy / raceEnergy)
+                 << "% less energy for " << r.deadlineMisses - raceMisses << " more deadline misses\n";
+    }
+}
+
 // 🧩 Main Function (no input)
-int main() {
+// The cluster and DVFS demos run small; --large runs them at 10,000 CPUs /
+// 200,000 jobs and 1,024 CPUs / 1,000,000 jobs (several seconds).
+int main(int argc, char *argv[]) {
+    bool large = argc > 1 && string(argv[1]) == "--large";
     // Predefined process list
     vector<Process> p = {
         {1, 0, 5, 2},   // pid, AT, BT, Priority
@@ -155,6 +762,15 @@ int main() {
     sjf(p);
     prioritySched(p);
     roundRobin(p, quantum);
+    quantumDemo();
+    gangDemo();
+    if (large) {
+        clusterDemo(10000, 200000);
+        dvfsDemo(1024, 1000000);
+    } else {
+        clusterDemo(256, 5000);
+        dvfsDemo(64, 50000);
+    }
 
     return 0;
 }
@@ -175,7 +791,11 @@ Here’s a **short and clear code summary** you can include with your explanatio
   * `prioritySched()` → Implements **Priority (Non-Preemptive)** scheduling based on the smallest priority value.
   * `roundRobin()` → Implements **Round Robin (Preemptive)** using a queue and a fixed time quantum.
 * Each function calculates and prints **Completion Time**, **Turnaround Time**, **Waiting Time**, and their averages using a common `display()` function.
-* The `main()` function initializes process data, sets the quantum, and calls all four scheduling functions sequentially.
+* `optimizeQuantum()` → Searches the Round Robin **time quantum** for a chosen objective (mean WT, p99 response time or throughput with a context-switch cost): a coarse parallel sweep, then golden-section refinement, memoizing every simulated quantum.
+* `clusterSequential()` / `clusterParallel()` → Simulate **Round Robin on many CPUs** (e.g. 10,000). The parallel version splits the CPUs into groups, one host thread per group, and advances them in lookahead windows equal to the migration delay; migrated jobs travel through lock-free mailboxes. Both versions produce identical results.
+* `gangSchedule()` → **Gang scheduling** for multi-threaded jobs (`Process::threads`): all threads of a job run in the same time slice on CPUs allowed by its **affinity mask** (`Process::affinity`, up to 256 CPUs). Reports fragmentation (cores idle while gangs wait) and job slowdown. The multi-CPU Round Robin also honours affinity when placing and migrating jobs.
+* DVFS (`ClusterConfig::levels`) → Each CPU picks a **frequency level** per dispatch; burst time scales with frequency and every level has its own power draw. **Race-to-idle** always runs at top speed, **stretch-to-deadline** picks the slowest level whose projected finish, under RR with the jobs queued on that CPU plus one quantum of headroom each, still meets the job's deadline. It is a best-effort heuristic: later arrivals and migrations are not foreseen, so it saves energy at the cost of some extra deadline misses, which the demo reports. Total energy and the energy-delay product are reported next to TAT and WT.
+* The `main()` function initializes process data, sets the quantum, and calls all four scheduling functions sequentially, followed by small multi-CPU and DVFS demos (`--large` runs them at 10,000 and 1,024 CPUs).
 
 ---
 